@@ -0,0 +1,362 @@
+// Serialization microbenchmarks. Usage: openrouter-bench [filter]
+// [--min-time=SECONDS]. Runs every case whose name contains `filter` and
+// prints ns/op, throughput and heap allocations per operation.
+
+#include "json_writer.hpp"
+#include "openrouter/base64.hpp"
+#include "openrouter/serializer.hpp"
+#include "request_body.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace openrouter;
+
+static std::atomic<std::uint64_t> allocations = 0;
+
+void *operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  auto alignment = static_cast<std::size_t>(align);
+  if (void *p = std::aligned_alloc(alignment,
+                                   (size + alignment - 1) / alignment *
+                                       alignment)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+// GCC flags free() in a replaced operator delete as a mismatch.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+#pragma GCC diagnostic pop
+
+// Keeps the optimizer from discarding a benchmarked result.
+template <typename T> static void keep(T &&value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+static double min_time = 0.5;
+
+template <typename F>
+static void run(std::string_view filter, std::string_view name,
+                std::size_t bytes, F &&operation) {
+  if (name.find(filter) == std::string_view::npos) {
+    return;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  operation();
+
+  std::uint64_t iterations = 1;
+  for (;;) {
+    std::uint64_t before = allocations.load(std::memory_order_relaxed);
+    auto started = Clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i) {
+      operation();
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - started;
+    std::uint64_t allocated =
+        allocations.load(std::memory_order_relaxed) - before;
+
+    if (elapsed.count() >= min_time) {
+      double seconds = elapsed.count() / static_cast<double>(iterations);
+      std::printf("%-40.*s %14.0f %12.1f %14.1f\n",
+                  static_cast<int>(name.size()), name.data(), seconds * 1e9,
+                  static_cast<double>(bytes) / seconds / 1e6,
+                  static_cast<double>(allocated) /
+                      static_cast<double>(iterations));
+      return;
+    }
+    iterations *= 2;
+  }
+}
+
+// Deterministic prose with the characters the writer has to escape.
+static std::string text(std::size_t size, unsigned seed) {
+  static constexpr std::string_view words[] = {
+      "the",     "model",  "returns", "a",      "response", "with",
+      "quoted",  "\"text\"", "and",   "new\nlines", "über", "tabs\t",
+      "tokens,", "plus",   "numbers", "42",     "€",        "done."};
+  std::minstd_rand rng(seed);
+  std::string out;
+  out.reserve(size + 16);
+  for (;;) {
+    std::string_view word = words[rng() % std::size(words)];
+    if (out.size() + word.size() + 1 > size) {
+      // Pad rather than cut a multi-byte character in half.
+      out.append(size - out.size(), ' ');
+      return out;
+    }
+    out += word;
+    out += ' ';
+  }
+}
+
+static std::vector<std::byte> random_bytes(std::size_t size) {
+  std::mt19937_64 rng(7);
+  std::vector<std::byte> bytes(size);
+  for (auto &b : bytes) {
+    b = static_cast<std::byte>(rng());
+  }
+  return bytes;
+}
+
+static OpenResponsesEasyInputMessage
+message(OpenResponsesEasyInputMessage::Role role, std::string content) {
+  return {role, {std::move(content)}};
+}
+
+static std::string arguments(unsigned seed) {
+  return nlohmann::json{{"query", text(120, seed)},
+                        {"limit", 10},
+                        {"filters", {{"lang", "en"}, {"recent", true}}}}
+      .dump();
+}
+
+struct Corpus {
+  std::string name;
+  Request request;
+};
+
+static std::vector<Corpus>
+request_corpora(const std::vector<std::byte> &image) {
+  using Role = OpenResponsesEasyInputMessage::Role;
+  std::vector<Corpus> corpora;
+
+  Request small;
+  small.model = "openai/gpt-4o-mini";
+  small.input = std::vector<OpenResponsesInput>{
+      message(Role::System, "You are a helpful assistant."),
+      message(Role::User, text(160, 1))};
+  corpora.push_back({"small_turn", std::move(small)});
+
+  Request history;
+  history.model = "anthropic/claude-sonnet-4";
+  std::vector<OpenResponsesInput> turns;
+  turns.push_back(message(Role::System, text(2000, 2)));
+  for (unsigned i = 0; turns.size() < 400; ++i) {
+    turns.push_back(message(Role::User, text(1000, 3 + i)));
+    turns.push_back(ResponsesOutputMessage{
+        {ResponseOutputText{text(1500, 1000 + i), std::nullopt}},
+        "msg_" + std::to_string(i),
+        ResponsesOutputMessage::Completed});
+  }
+  // The same history as a conversation, with only the next turn to encode.
+  Request next_turn;
+  next_turn.model = history.model;
+  auto conversation = std::make_shared<Conversation>();
+  for (const auto &turn : turns) {
+    conversation->append(turn);
+  }
+  next_turn.conversation = std::move(conversation);
+  next_turn.input = text(1000, 2);
+
+  history.input = std::move(turns);
+  corpora.push_back({"history_500k", std::move(history)});
+  corpora.push_back({"history_500k_conversation", std::move(next_turn)});
+
+  Request tools;
+  tools.model = "openai/gpt-4o";
+  std::vector<OpenResponsesInput> calls;
+  calls.push_back(message(Role::User, text(300, 4)));
+  for (unsigned i = 0; i < 100; ++i) {
+    auto id = "call_" + std::to_string(i);
+    calls.push_back(ResponsesOutputItemFunctionCall{
+        arguments(i), id, "search_documents", "fc_" + std::to_string(i),
+        ResponsesOutputItemFunctionCall::Completed});
+    calls.push_back(OpenResponsesFunctionCallOutput{
+        id, text(500, 5000 + i), std::nullopt, std::nullopt});
+  }
+  tools.input = std::move(calls);
+  corpora.push_back({"tool_calls_100", std::move(tools)});
+
+  Request attachment;
+  attachment.model = "google/gemini-2.5-flash";
+  InputImage streamed{InputImage::Auto, std::nullopt,
+                      Attachment::from_bytes(image, "image/png")};
+  attachment.input = std::vector<OpenResponsesInput>{
+      OpenResponsesEasyInputMessage{
+          Role::User, {InputText{"Describe this image."}, streamed}}};
+  corpora.push_back({"attachment_4m", std::move(attachment)});
+
+  Request inline_image;
+  inline_image.model = "google/gemini-2.5-flash";
+  inline_image.input = std::vector<OpenResponsesInput>{
+      OpenResponsesEasyInputMessage{
+          Role::User,
+          {InputText{"Describe this image."},
+           make_input_image(image, "image/png")}}};
+  corpora.push_back({"inline_base64_4m", std::move(inline_image)});
+
+  return corpora;
+}
+
+static nlohmann::json response_envelope(nlohmann::json output) {
+  return {{"id", "resp_bench"},
+          {"object", "response"},
+          {"created_at", 1760000000},
+          {"model", "openai/gpt-4o"},
+          {"status", "completed"},
+          {"output", std::move(output)},
+          {"usage",
+           {{"input_tokens", 1200},
+            {"output_tokens", 800},
+            {"total_tokens", 2000}}}};
+}
+
+static nlohmann::json output_message(std::string id, std::string content) {
+  return {{"type", "message"},
+          {"id", std::move(id)},
+          {"status", "completed"},
+          {"role", "assistant"},
+          {"content",
+           {{{"type", "output_text"},
+             {"text", std::move(content)},
+             {"annotations", nlohmann::json::array()}}}}};
+}
+
+struct Body {
+  std::string name;
+  std::string json;
+};
+
+static std::vector<Body> response_corpora(const std::vector<std::byte> &image) {
+  std::vector<Body> corpora;
+
+  corpora.push_back(
+      {"small_turn",
+       response_envelope({output_message("msg_0", text(300, 10))}).dump()});
+
+  nlohmann::json long_output = nlohmann::json::array();
+  nlohmann::json summary = {{"type", "summary_text"}, {"text", text(800, 11)}};
+  long_output.push_back({{"type", "reasoning"},
+                         {"id", "rs_0"},
+                         {"summary", {std::move(summary)}},
+                         {"content", nlohmann::json::array()},
+                         {"encrypted_content", text(4000, 12)}});
+  nlohmann::json parts = nlohmann::json::array();
+  for (unsigned i = 0; i < 100; ++i) {
+    parts.push_back(
+        {{"type", "output_text"},
+         {"text", text(5000, 100 + i)},
+         {"annotations",
+          {{{"type", "url_citation"},
+            {"url", "https://example.com/source/" + std::to_string(i)},
+            {"title", "Source " + std::to_string(i)},
+            {"start_index", 10},
+            {"end_index", 90}}}}});
+  }
+  long_output.push_back({{"type", "message"},
+                         {"id", "msg_long"},
+                         {"status", "completed"},
+                         {"role", "assistant"},
+                         {"content", std::move(parts)}});
+  corpora.push_back({"history_500k", response_envelope(long_output).dump()});
+
+  nlohmann::json calls = nlohmann::json::array();
+  for (unsigned i = 0; i < 100; ++i) {
+    calls.push_back({{"type", "function_call"},
+                     {"id", "fc_" + std::to_string(i)},
+                     {"call_id", "call_" + std::to_string(i)},
+                     {"name", "search_documents"},
+                     {"arguments", arguments(i)},
+                     {"status", "completed"}});
+  }
+  corpora.push_back({"tool_calls_100", response_envelope(calls).dump()});
+
+  corpora.push_back(
+      {"image_4m",
+       response_envelope({{{"type", "image_generation_call"},
+                           {"id", "ig_0"},
+                           {"status", "completed"},
+                           {"result", base64_encode(image)}}})
+           .dump()});
+
+  return corpora;
+}
+
+int main(int argc, char **argv) {
+  std::string_view filter;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg.starts_with("--min-time=")) {
+      min_time = std::atof(argv[i] + 11);
+    } else {
+      filter = arg;
+    }
+  }
+
+  auto image = random_bytes(4 * 1024 * 1024);
+  auto requests = request_corpora(image);
+  auto responses = response_corpora(image);
+
+  std::printf("%-40s %14s %12s %14s\n", "benchmark", "ns/op", "MB/s",
+              "allocs/op");
+
+  std::string out;
+  static char chunk[64 * 1024];
+  for (const auto &[name, request] : requests) {
+    out.clear();
+    serialize(request, out);
+    std::size_t bytes = out.size();
+
+    // serialize() flattens attachments into the string; requests are sent
+    // from a RequestBody instead, which encodes them as curl reads it.
+    run(filter, "encode/" + name + "/serialize", bytes, [&] {
+      out.clear();
+      serialize(request, out);
+      keep(out);
+    });
+    run(filter, "encode/" + name + "/request_body", bytes, [&] {
+      RequestBody body;
+      JsonWriter writer(body);
+      write(writer, request);
+      while (body.read(chunk, sizeof(chunk)) != 0) {
+        keep(chunk);
+      }
+    });
+    run(filter, "encode/" + name + "/to_json", bytes, [&] {
+      std::string dumped = nlohmann::json(request).dump();
+      keep(dumped);
+    });
+  }
+
+  pmr::Response arena_response;
+  for (const auto &[name, json] : responses) {
+    run(filter, "decode/" + name + "/deserialize", json.size(), [&] {
+      Response response;
+      deserialize(json, response);
+      keep(response);
+    });
+    run(filter, "decode/" + name + "/deserialize_pmr", json.size(), [&] {
+      deserialize(json, arena_response);
+      keep(arena_response);
+    });
+    run(filter, "decode/" + name + "/from_json", json.size(), [&] {
+      Response response = nlohmann::json::parse(json).get<Response>();
+      keep(response);
+    });
+  }
+}
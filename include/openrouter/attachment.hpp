@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace openrouter {
+
+// Raw attachment bytes that are base64-encoded only while the request body
+// is being sent. Copies share the underlying storage.
+class Attachment {
+public:
+  // The bytes are borrowed and must outlive every request that uses them.
+  static Attachment from_bytes(std::span<const std::byte> bytes,
+                               std::string mime_type = {});
+  // Memory-maps the file; the mapping lives as long as any copy does.
+  static Attachment from_file(const std::filesystem::path &path,
+                              std::string mime_type = {});
+
+  std::span<const std::byte> bytes() const { return data; }
+  // When set, the payload is sent as a data URL rather than bare base64.
+  const std::string &mime_type() const { return mime; }
+
+  // Fully encoded payload, for callers that need it in memory.
+  std::string encode(bool data_url = true) const;
+
+private:
+  std::shared_ptr<const void> storage;
+  std::span<const std::byte> data;
+  std::string mime;
+};
+
+} // namespace openrouter
@@ -0,0 +1,42 @@
+#pragma once
+#include "openrouter/responses.hpp"
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openrouter {
+
+// Standard-alphabet base64 with padding. Uses AVX2 or SSSE3 when the CPU
+// supports them and a scalar loop otherwise.
+
+constexpr size_t base64_encoded_size(size_t size) { return (size + 2) / 3 * 4; }
+
+// Exact decoded size of `encoded`, accounting for padding.
+size_t base64_decoded_size(std::string_view encoded);
+
+// Writes exactly base64_encoded_size(in.size()) characters to `out`.
+void base64_encode(std::span<const std::byte> in, char *out);
+std::string base64_encode(std::span<const std::byte> in);
+
+// Returns the number of bytes written. Throws on malformed input or when
+// `out` is smaller than base64_decoded_size(in).
+size_t base64_decode(std::string_view in, std::span<std::byte> out);
+std::vector<std::byte> base64_decode(std::string_view in);
+
+InputFile make_input_file(std::span<const std::byte> bytes,
+                          std::string filename, std::string_view mime_type);
+InputImage make_input_image(std::span<const std::byte> bytes,
+                            std::string_view mime_type,
+                            InputImage::Detail detail = InputImage::Auto);
+InputAudio make_input_audio(std::span<const std::byte> bytes,
+                            InputAudio::Format format);
+
+// Decoded size of an image generation result, accepting either bare base64
+// or a data URL. Zero when the call carries no result.
+size_t image_result_size(const ResponsesImageGenerationCall &call);
+size_t decode_image_result(const ResponsesImageGenerationCall &call,
+                           std::span<std::byte> out);
+
+} // namespace openrouter
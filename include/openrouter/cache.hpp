@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace openrouter {
+
+// Opt-in cache of non-streaming responses, keyed on a hash of the
+// serialized request. Entries never expire; the cache suits byte-identical
+// replays such as evaluations, not sampled conversations.
+struct CachePolicy {
+  bool enabled = false;
+  // Bound on the in-memory tier, split evenly across `shards`.
+  std::size_t max_bytes = 64 * 1024 * 1024;
+  std::size_t shards = 16;
+  // Directory of the persistent tier, created if missing. Empty keeps the
+  // cache in memory. Delete the directory to clear it. One client at a time
+  // may use a directory; opening one already in use throws.
+  std::string directory;
+  // Bound on the persistent tier's data file. A body that would overflow it
+  // first drops the oldest bodies until half the bound is free.
+  std::size_t max_disk_bytes = 1024 * 1024 * 1024;
+};
+
+struct CacheStats {
+  std::uint64_t hits = 0;
+  // Memory misses served by the persistent tier.
+  std::uint64_t disk_hits = 0;
+  std::uint64_t misses = 0;
+  // Entries dropped from memory to stay under max_bytes.
+  std::uint64_t evictions = 0;
+  std::size_t entries = 0;
+  std::size_t bytes = 0;
+};
+
+} // namespace openrouter
@@ -0,0 +1,31 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace openrouter {
+
+struct CompressionPolicy {
+  // Ask for compressed responses in every encoding curl was built with.
+  bool decode_responses = true;
+  // Gzip request bodies of at least `min_size` bytes. Off by default since
+  // the endpoint, or a proxy in front of it, must accept
+  // `Content-Encoding: gzip`.
+  bool compress_requests = false;
+  std::size_t min_size = 16 * 1024;
+  // zlib level, 1 (fastest) to 9 (smallest).
+  int level = 6;
+};
+
+struct CompressionStats {
+  // Bodies sent compressed. Those that did not shrink go out as they were.
+  std::uint64_t compressed = 0;
+  std::uint64_t skipped = 0;
+  // Sizes of the compressed bodies before and after.
+  std::uint64_t bytes_in = 0;
+  std::uint64_t bytes_out = 0;
+  // Time spent compressing, skipped bodies included.
+  std::chrono::microseconds time{};
+};
+
+} // namespace openrouter
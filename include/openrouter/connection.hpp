@@ -0,0 +1,54 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace openrouter {
+
+enum class HttpVersion {
+  Http1,
+  // Offered through ALPN on https; servers without it, and http:// URLs, get
+  // HTTP/1.1.
+  Http2,
+  // HTTP/2 without negotiation, for http:// endpoints such as local proxies
+  // known to speak h2c.
+  Http2PriorKnowledge,
+};
+
+// How transfers map onto connections. Multiplexing applies to asynchronous
+// calls, which share one event loop; synchronous calls reuse idle
+// connections but never share one concurrently.
+struct ConnectionPolicy {
+  HttpVersion http_version = HttpVersion::Http2;
+  // Streams carried by one HTTP/2 connection before another is opened. The
+  // server's own limit applies on top.
+  long max_concurrent_streams = 100;
+  // Connections per host, 0 for no limit. Transfers beyond it wait for a free
+  // connection or stream.
+  long max_host_connections = 0;
+  // Idle connections kept open for reuse. curl's default of 5 makes any more
+  // concurrent callers than that reconnect on almost every call.
+  long max_idle_connections = 64;
+  // Idle connections older than this are closed rather than reused.
+  std::chrono::seconds max_idle_age{118};
+  // TCP keepalive probes on idle connections, so that NATs and load
+  // balancers neither drop them silently nor leave dead ones to be found by
+  // the next call. Zero idle time disables probing.
+  std::chrono::seconds keepalive_idle{30};
+  std::chrono::seconds keepalive_interval{15};
+  // Connections opened in the background when the client is created, as by
+  // OpenRouter::prewarm().
+  std::size_t prewarm = 0;
+};
+
+struct ConnectionStats {
+  // Transfers that got as far as sending a request.
+  std::uint64_t transfers = 0;
+  // Those that had to open a connection, and those that found one.
+  std::uint64_t new_connections = 0;
+  std::uint64_t reused = 0;
+  // Transfers carried over HTTP/2.
+  std::uint64_t http2 = 0;
+};
+
+} // namespace openrouter
@@ -0,0 +1,39 @@
+#pragma once
+#include <chrono>
+#include <curl/curl.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace openrouter {
+
+// The API answered with a non-2xx status.
+class HttpError : public std::runtime_error {
+public:
+  HttpError(long status, const std::string &message,
+            std::optional<std::chrono::seconds> retry_after = std::nullopt);
+
+  long status() const { return http_status; }
+  // From the Retry-After header, in either of its forms.
+  const std::optional<std::chrono::seconds> &retry_after() const {
+    return retry_hint;
+  }
+
+private:
+  long http_status;
+  std::optional<std::chrono::seconds> retry_hint;
+};
+
+// The transfer failed before a complete response arrived.
+class TransportError : public std::runtime_error {
+public:
+  explicit TransportError(CURLcode code)
+      : std::runtime_error(curl_easy_strerror(code)), curl_code(code) {}
+
+  CURLcode code() const { return curl_code; }
+
+private:
+  CURLcode curl_code;
+};
+
+} // namespace openrouter
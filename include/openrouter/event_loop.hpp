@@ -0,0 +1,150 @@
+#pragma once
+#include "openrouter/task.hpp"
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace openrouter {
+
+// What a watch waits for, and what a ready socket is ready for. Errors and
+// hangups are reported as ReadWrite.
+enum class Interest {
+  None = 0,
+  Read = 1,
+  Write = 2,
+  ReadWrite = Read | Write,
+};
+
+// A loop the caller owns, such as an existing epoll reactor, that a client
+// can run its asynchronous calls on instead of a thread of its own. Every
+// member but post() is only called on the loop thread, possibly from inside
+// one of its handlers, and handlers must run on that thread too.
+class EventLoop {
+public:
+  using Callback = std::move_only_function<void()>;
+  using Handler = std::move_only_function<void(Interest ready)>;
+  using TimerId = std::uint64_t;
+
+  virtual ~EventLoop() = default;
+
+  // Runs `on_ready` whenever `fd` is ready for some of `interest`,
+  // replacing the handler and interest of an earlier watch() of `fd`.
+  virtual void watch(int fd, Interest interest, Handler on_ready) = 0;
+  virtual void unwatch(int fd) = 0;
+
+  // Runs `callback` once after `delay`. Cancelling a timer that has already
+  // fired does nothing.
+  virtual TimerId add_timer(std::chrono::milliseconds delay,
+                            Callback callback) = 0;
+  virtual void cancel_timer(TimerId id) = 0;
+
+  // Runs `callback` on the loop thread soon. Safe from any thread.
+  virtual void post(Callback callback) = 0;
+};
+
+// A minimal EventLoop on poll(2), for programs without one of their own.
+class PollLoop final : public EventLoop {
+public:
+  PollLoop();
+  ~PollLoop() override;
+
+  PollLoop(const PollLoop &) = delete;
+  PollLoop &operator=(const PollLoop &) = delete;
+
+  // Runs handlers until stop() is called, returning at once if it was
+  // called since the last run.
+  void run();
+  // Runs handlers until `task` has finished, and returns its result or
+  // rethrows its exception.
+  template <typename T> T run(Task<T> task);
+  // Safe from any thread.
+  void stop();
+
+  void watch(int fd, Interest interest, Handler on_ready) override;
+  void unwatch(int fd) override;
+  TimerId add_timer(std::chrono::milliseconds delay,
+                    Callback callback) override;
+  void cancel_timer(TimerId id) override;
+  void post(Callback callback) override;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Watch {
+    Interest interest;
+    // Shared so that a handler can replace or remove its own watch.
+    std::shared_ptr<Handler> on_ready;
+  };
+
+  struct Timer {
+    Clock::time_point due;
+    Callback callback;
+  };
+
+  void wait(Clock::time_point deadline);
+  void fire_timers();
+
+  std::map<int, Watch> watches;
+  std::unordered_map<TimerId, Timer> timers;
+  std::set<std::pair<Clock::time_point, TimerId>> deadlines;
+  TimerId next_timer = 0;
+
+  // Written to wake a poll() from another thread.
+  int wake_read = -1;
+  int wake_write = -1;
+
+  std::mutex mutex;
+  std::vector<Callback> posted;
+  bool stopping = false;
+};
+
+template <typename T> T PollLoop::run(Task<T> task) {
+  detail::TaskResult<T> result;
+  std::exception_ptr error;
+  auto body = [&]() -> Task<> {
+    try {
+      if constexpr (std::is_void_v<T>) {
+        co_await std::move(task);
+      } else {
+        result.return_value(co_await std::move(task));
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    // The task may have been resumed on another thread, such as that of a
+    // client without an event loop; finish on this one.
+    struct Return {
+      PollLoop &loop;
+
+      bool await_ready() noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> handle) {
+        loop.post([handle] { handle.resume(); });
+      }
+      void await_resume() noexcept {}
+    };
+    co_await Return{*this};
+    stop();
+  };
+
+  auto driver = body();
+  driver.start();
+  while (!driver.done()) {
+    run();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return result.take();
+}
+
+} // namespace openrouter
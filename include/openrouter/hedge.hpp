@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+
+namespace openrouter {
+
+// Opt-in hedging for non-streaming calls. A call still running after
+// `percentile` of recent calls had finished gets a duplicate; the first
+// response wins and the other transfer is cancelled.
+struct HedgePolicy {
+  bool enabled = false;
+  double percentile = 0.95;
+  // Hedges are capped at this share of calls.
+  double max_fraction = 0.05;
+  // Latency samples kept, and how many are needed before hedging starts.
+  std::size_t window = 1000;
+  std::size_t min_samples = 50;
+};
+
+} // namespace openrouter
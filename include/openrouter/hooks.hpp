@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+
+namespace openrouter {
+
+struct Request;
+
+// Where the time of one attempt went. Transfer phases come from curl and,
+// like curl's, are cumulative from the start of the transfer, so TLS time is
+// `app_connect - connect` and server think time roughly
+// `start_transfer - pre_transfer`.
+struct RequestTiming {
+  // 1 for the first attempt, counting up through retries.
+  int attempt = 1;
+  // HTTP status, or 0 when no response arrived.
+  long status = 0;
+
+  std::chrono::microseconds name_lookup{};
+  std::chrono::microseconds connect{};
+  std::chrono::microseconds app_connect{};
+  std::chrono::microseconds pre_transfer{};
+  std::chrono::microseconds start_transfer{};
+  std::chrono::microseconds total{};
+  // As on the wire, so compressed bodies count their compressed size.
+  std::uint64_t bytes_sent = 0;
+  std::uint64_t bytes_received = 0;
+
+  // Time spent in the library serializing and compressing the request, once
+  // per call, and parsing this attempt's response.
+  std::chrono::microseconds serialize{};
+  std::chrono::microseconds compress{};
+  std::chrono::microseconds parse{};
+};
+
+// Hooks must not throw. Cache hits make no attempt and report nothing after
+// the request.
+struct RequestHooks {
+  // Runs on the calling thread before the request is serialized.
+  std::function<void(const Request &)> before_request;
+  // Runs after every attempt, failed ones included, on the thread that
+  // performed it: the caller's for synchronous calls, the event loop's for
+  // asynchronous ones. `error` is null on success.
+  std::function<void(const RequestTiming &, std::exception_ptr error)>
+      after_attempt;
+};
+
+} // namespace openrouter
@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace openrouter {
+
+// Client-side only; never sent. Queued interactive calls always start ahead
+// of normal ones, and normal ones ahead of batch work.
+enum class Priority {
+  Interactive,
+  Normal,
+  Batch,
+};
+
+// Bounds outbound load. The number of calls in flight is capped by a window
+// that grows by `increase` per window's worth of healthy responses and is
+// multiplied by `decrease` on a 429 or 503, or when recent latency climbs
+// past `latency_tolerance` times its long-run average. Retries run inside
+// their call's slot. Calls beyond the window wait in priority order.
+struct LimiterPolicy {
+  bool enabled = false;
+
+  double initial_window = 16;
+  double min_window = 1;
+  double max_window = 256;
+  double increase = 1;
+  double decrease = 0.5;
+  double latency_tolerance = 2;
+  // The window shrinks at most once per round trip. This stands in for the
+  // round trip until a response has measured it.
+  std::chrono::milliseconds initial_rtt{1000};
+
+  // Token bucket on call starts; a rate of 0 disables it.
+  double rate = 0;
+  double burst = 10;
+};
+
+struct LimiterStats {
+  double window = 0;
+  std::size_t in_flight = 0;
+  std::size_t queued = 0;
+  // Indexed by Priority.
+  std::array<std::size_t, 3> queued_by_priority{};
+};
+
+} // namespace openrouter
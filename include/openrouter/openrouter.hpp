@@ -1,27 +1,152 @@
 #pragma once
+#include "openrouter/cache.hpp"
+#include "openrouter/compression.hpp"
+#include "openrouter/connection.hpp"
+#include "openrouter/error.hpp"
+#include "openrouter/event_loop.hpp"
+#include "openrouter/hedge.hpp"
+#include "openrouter/hooks.hpp"
+#include "openrouter/limiter.hpp"
+#include "openrouter/pmr.hpp"
 #include "openrouter/responses.hpp"
+#include "openrouter/retry.hpp"
+#include "openrouter/streaming.hpp"
+#include <coroutine>
 #include <curl/curl.h>
+#include <exception>
+#include <expected>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace openrouter {
 
+class Compressor;
+class Engine;
+class HandlePool;
+class Hedger;
+class Limiter;
+class RequestBody;
+class ResponseCache;
+class Retrier;
+
+using StreamCallback = std::function<void(const ResponseStreamEvent &)>;
+using ResponseResult = std::expected<Response, std::exception_ptr>;
+using ResponseCallback = std::function<void(ResponseResult)>;
+
+struct BulkOptions {
+  std::size_t max_in_flight = 16;
+  // Called on the event-loop thread after each request finishes; must not
+  // block.
+  std::function<void(std::size_t completed, std::size_t total)> on_progress;
+};
+
+struct ClientOptions {
+  // Requests go to `{base_url}/responses`.
+  std::string base_url = "https://openrouter.ai/api/v1";
+  RetryPolicy retry;
+  HedgePolicy hedge;
+  LimiterPolicy limiter;
+  CachePolicy cache;
+  ConnectionPolicy connection;
+  CompressionPolicy compression;
+  RequestHooks hooks;
+  // Runs asynchronous calls on this loop instead of a thread of the
+  // client's own. The loop must outlive the client, which must then be
+  // destroyed on the loop thread. Calls that block on asynchronous ones,
+  // such as prewarm(), create_responses() or create_response() with hedging
+  // enabled, must not be made from it.
+  EventLoop *event_loop = nullptr;
+};
+
+// What co_create_response() returns. The call is already running; awaiting
+// it suspends the coroutine until the call finishes and resumes it on the
+// thread that finished it, which must not be blocked.
+class ResponseAwaitable {
+public:
+  bool await_ready() const noexcept;
+  bool await_suspend(std::coroutine_handle<> waiter);
+  Response await_resume();
+
+private:
+  friend class OpenRouter;
+  struct State;
+
+  explicit ResponseAwaitable(std::shared_ptr<State> state);
+
+  std::shared_ptr<State> state;
+};
+
+// Thread-safe: any number of threads may share one client. Handles are pooled
+// and share DNS, TLS session and connection caches.
 class OpenRouter {
-  CURL *curl = nullptr;
+  ClientOptions options;
+  std::string responses_url;
   curl_slist *headers = nullptr;
+  std::unique_ptr<HandlePool> pool;
+  std::unique_ptr<Retrier> retrier;
+  std::unique_ptr<Hedger> hedger;
+  std::unique_ptr<Limiter> limiter;
+  std::unique_ptr<ResponseCache> cache;
+  std::unique_ptr<Compressor> compressor;
+  std::unique_ptr<Engine> engine;
+  std::once_flag engine_once;
+
+  Engine &get_engine();
+  std::future<void> warm(std::size_t connections);
 
-  std::string http_get(const std::string &url);
-  std::string http_post(const std::string &url, const std::string &data);
+  CURLcode http_post(CURL *curl, const std::string &url, RequestBody &body,
+                     curl_write_callback write, void *userdata);
 
 public:
-  explicit OpenRouter(std::optional<std::string_view> api_key = std::nullopt);
+  explicit OpenRouter(std::optional<std::string_view> api_key = std::nullopt,
+                      ClientOptions options = {});
   ~OpenRouter();
 
   OpenRouter(const OpenRouter &) = delete;
   OpenRouter &operator=(const OpenRouter &) = delete;
 
+  // Resolves, connects and completes TLS and protocol negotiation for
+  // `connections` connections, so the first calls do not pay for them.
+  // Blocks until every attempt has finished; throws TransportError if none
+  // succeeded.
+  void prewarm(std::size_t connections = 1);
+
   Response create_response(const Request &request);
+  Response create_response(const Request &request,
+                           const StreamCallback &on_event);
+  // Decodes into the arena of `response`, replacing its previous contents.
+  void create_response(const Request &request, pmr::Response &response);
+
+  // These share one event-loop thread per client, or run on
+  // ClientOptions::event_loop. Callbacks run on that thread and must not
+  // block. With hedging enabled, the synchronous non-streaming overload also
+  // goes through this path.
+  std::future<Response> create_response_async(const Request &request);
+  void create_response_async(const Request &request, ResponseCallback callback);
+  // The same call for coroutines: `co_await client.co_create_response(req)`
+  // yields the response or throws.
+  ResponseAwaitable co_create_response(const Request &request);
+
+  // Runs up to `options.max_in_flight` requests at a time through the
+  // asynchronous path, serializing the next request while earlier ones are
+  // on the wire. Results, or per-request errors, come back in input order.
+  std::vector<ResponseResult>
+  create_responses(std::span<const Request> requests,
+                   const BulkOptions &options = {});
+
+  // Current concurrency window and queue depth of ClientOptions::limiter.
+  LimiterStats limiter_stats() const;
+  CacheStats cache_stats() const;
+  // How transfers so far were spread over connections.
+  ConnectionStats connection_stats() const;
+  CompressionStats compression_stats() const;
 };
 
 } // namespace openrouter
@@ -0,0 +1,123 @@
+#pragma once
+#include "openrouter/responses.hpp"
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+// Arena-backed mirrors of the response types. Every string and vector in a
+// decoded pmr::Response comes from one monotonic arena owned by the Response,
+// so a decode makes a handful of large allocations and is freed in one step.
+namespace openrouter::pmr {
+
+struct ResponseOutputText {
+  struct FileCitation {
+    std::pmr::string file_id;
+    std::pmr::string filename;
+    double index;
+  };
+
+  struct URLCitation {
+    std::pmr::string url;
+    std::pmr::string title;
+    double start_index;
+    double end_index;
+  };
+
+  struct FilePath {
+    std::pmr::string file_id;
+    double index;
+  };
+
+  using Annotation = std::variant<FileCitation, URLCitation, FilePath>;
+
+  std::pmr::string text;
+  std::optional<std::pmr::vector<Annotation>> annotations;
+};
+
+struct OpenAIResponsesRefusalContent {
+  std::pmr::string refusal;
+};
+
+struct ResponsesOutputMessage {
+  using Status = openrouter::ResponsesOutputMessage::Status;
+
+  std::pmr::vector<
+      std::variant<ResponseOutputText, OpenAIResponsesRefusalContent>>
+      content;
+  std::pmr::string id;
+  std::optional<Status> status;
+};
+
+struct ResponsesOutputItemReasoning {
+  using Status = openrouter::ResponsesOutputItemReasoning::Status;
+
+  std::pmr::string id;
+  std::pmr::vector<std::pmr::string> summary;
+  std::optional<std::pmr::vector<std::pmr::string>> content;
+  std::optional<std::pmr::string> encrypted_content;
+  std::optional<Status> status;
+};
+
+struct ResponsesOutputItemFunctionCall {
+  using Status = openrouter::ResponsesOutputItemFunctionCall::Status;
+
+  std::pmr::string arguments;
+  std::pmr::string call_id;
+  std::pmr::string name;
+  std::optional<std::pmr::string> id;
+  std::optional<Status> status;
+};
+
+struct ResponsesWebSearchCallOutput {
+  using Status = openrouter::ResponsesWebSearchCallOutput::Status;
+
+  std::pmr::string id;
+  Status status;
+};
+
+struct ResponsesOutputItemFileSearchCall {
+  using Status = openrouter::ResponsesOutputItemFileSearchCall::Status;
+
+  std::pmr::string id;
+  std::pmr::vector<std::pmr::string> queries;
+  Status status;
+};
+
+struct ResponsesImageGenerationCall {
+  using Status = openrouter::ResponsesImageGenerationCall::Status;
+
+  std::pmr::string id;
+  Status status;
+  std::optional<std::pmr::string> result;
+};
+
+using ResponseOutputItem =
+    std::variant<ResponsesOutputMessage, ResponsesOutputItemReasoning,
+                 ResponsesOutputItemFunctionCall, ResponsesWebSearchCallOutput,
+                 ResponsesOutputItemFileSearchCall,
+                 ResponsesImageGenerationCall>;
+
+// Decoding into the same Response again releases the previous contents
+// first. A moved-from Response may only be destroyed or assigned to.
+class Response {
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+
+public:
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  explicit Response(std::size_t initial_size = 16 * 1024);
+  Response(Response &&other) noexcept = default;
+  Response &operator=(Response &&other) noexcept;
+
+  allocator_type get_allocator() const { return arena.get(); }
+
+  // Drops the output and returns the arena's memory upstream.
+  void clear();
+
+  std::optional<std::pmr::vector<ResponseOutputItem>> output;
+};
+
+} // namespace openrouter::pmr
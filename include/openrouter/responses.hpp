@@ -1,6 +1,10 @@
 #pragma once
+#include "openrouter/attachment.hpp"
+#include "openrouter/limiter.hpp"
 #include "nlohmann/json_fwd.hpp"
+#include <memory>
 #include <optional>
+#include <string_view>
 #include <string>
 #include <variant>
 #include <vector>
@@ -22,6 +26,9 @@ struct InputImage {
 
   Detail detail;
   std::optional<std::string> url;
+  // Sent as image_url in place of `url`; needs a MIME type to form a data
+  // URL.
+  std::optional<Attachment> attachment;
 };
 
 void to_json(nlohmann::json &j, const InputImage &image);
@@ -31,6 +38,8 @@ struct InputFile {
   std::optional<std::string> data;
   std::optional<std::string> filename;
   std::optional<std::string> url;
+  // Sent as file_data in place of `data`.
+  std::optional<Attachment> attachment;
 };
 
 void to_json(nlohmann::json &j, const InputFile &file);
@@ -43,6 +52,8 @@ struct InputAudio {
 
   Format format;
   std::string data;
+  // Sent in place of `data`.
+  std::optional<Attachment> attachment;
 };
 
 void to_json(nlohmann::json &j, const InputAudio &audio);
@@ -293,10 +304,46 @@ using OpenResponsesInput =
 
 void to_json(nlohmann::json &j, const OpenResponsesInput &input);
 
+struct Request;
+class Conversation;
+class RequestBody;
+
+// The invariant head of a request, such as the model and a long system
+// message, serialized once. Requests that carry a prefix splice their own
+// input items after its items. Copies share the frozen bytes, and
+// attachments stay raw bytes that each transfer encodes as it sends them.
+class RequestPrefix {
+public:
+  // Freezes `shared.model` and `shared.input`; other fields are ignored. A
+  // string input becomes a user message.
+  explicit RequestPrefix(const Request &shared);
+
+  const std::optional<std::string> &model() const;
+  const std::vector<OpenResponsesInput> &input() const;
+
+  // `"model":...` members and comma-separated input items, ready to splice.
+  std::string_view members_json() const;
+  const RequestBody &items_body() const;
+
+private:
+  struct Frozen;
+  std::shared_ptr<const Frozen> frozen;
+};
+
 struct Request {
   std::optional<std::variant<std::string, std::vector<OpenResponsesInput>>>
       input;
   std::optional<std::string> model;
+  std::optional<bool> stream;
+  // When set, `model` must be unset if the prefix has one, and `input` is
+  // appended after the prefix items.
+  std::optional<RequestPrefix> prefix;
+  // When set, its items follow the prefix items and precede `input`. It is
+  // only read while a call serializes the request, so it may grow again as
+  // soon as the call returns.
+  std::shared_ptr<const Conversation> conversation;
+  // Queue position under ClientOptions::limiter.
+  Priority priority = Priority::Normal;
 };
 
 void to_json(nlohmann::json &j, const Request &req);
@@ -311,4 +358,38 @@ struct Response {
 
 void from_json(const nlohmann::json &j, Response &resp);
 
+// The input of a multi-turn session, growing a turn at a time. Each item is
+// serialized once, when it is appended, so a request carrying the
+// conversation only encodes what was added since the last turn. Attachments
+// stay raw bytes that each transfer encodes as it sends them.
+class Conversation {
+public:
+  Conversation();
+  Conversation(const Conversation &other);
+  Conversation(Conversation &&other) noexcept;
+  Conversation &operator=(const Conversation &other);
+  Conversation &operator=(Conversation &&other) noexcept;
+  ~Conversation();
+
+  // Appends a user message.
+  void append(std::string text);
+  void append(OpenResponsesInput item);
+  // Appends every output item of `response`, such as its messages and
+  // function calls, to be sent back as input. If one fails, none is added.
+  void append(const Response &response);
+  // Drops the items from `size` on, e.g. to retry a turn.
+  void truncate(std::size_t size);
+
+  std::size_t size() const { return items.size(); }
+  const std::vector<OpenResponsesInput> &input() const { return items; }
+  // Comma-separated input items, ready to splice.
+  const RequestBody &items_body() const;
+
+private:
+  struct Encoded;
+
+  std::vector<OpenResponsesInput> items;
+  std::unique_ptr<Encoded> encoded;
+};
+
 } // namespace openrouter
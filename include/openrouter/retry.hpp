@@ -0,0 +1,26 @@
+#pragma once
+#include <chrono>
+
+namespace openrouter {
+
+// Transport failures and 408, 425, 429, 500, 502, 503 and 504 answers are
+// retried with jittered exponential backoff, added to the server's
+// Retry-After when it sends one. Other failures surface immediately.
+struct RetryPolicy {
+  // Total attempts including the first; 1 disables retries.
+  int max_attempts = 3;
+  std::chrono::milliseconds base_delay{200};
+  std::chrono::milliseconds max_delay{10'000};
+  // A longer Retry-After fails the call rather than waiting it out.
+  std::chrono::milliseconds max_retry_after{60'000};
+
+  // Client-wide budget that keeps retries from amplifying an outage: each
+  // first attempt earns `budget_ratio` retries, up to `budget_max_tokens`
+  // banked, and a floor of `budget_min_per_second` lets quiet clients retry
+  // at all. The floor never banks more than one second's worth.
+  double budget_ratio = 0.2;
+  double budget_min_per_second = 10.0;
+  double budget_max_tokens = 100.0;
+};
+
+} // namespace openrouter
@@ -0,0 +1,20 @@
+#pragma once
+#include "openrouter/pmr.hpp"
+#include "openrouter/responses.hpp"
+#include <string>
+#include <string_view>
+
+namespace openrouter {
+
+// Append the wire JSON for a value to `out` without building a
+// nlohmann::json tree. Reusing `out` across calls avoids reallocations.
+void serialize(const Request &request, std::string &out);
+void serialize(const OpenResponsesInput &input, std::string &out);
+
+// Decode a response body straight into `response` without a DOM. Throws if
+// the body is an API error object.
+void deserialize(std::string_view json, Response &response);
+// Decodes into the arena of `response`, releasing its previous contents.
+void deserialize(std::string_view json, pmr::Response &response);
+
+} // namespace openrouter
@@ -0,0 +1,57 @@
+#pragma once
+#include "openrouter/responses.hpp"
+#include "nlohmann/json_fwd.hpp"
+#include <string>
+#include <variant>
+
+namespace openrouter {
+
+struct ResponseOutputTextDelta {
+  std::string item_id;
+  int output_index;
+  int content_index;
+  std::string delta;
+};
+
+void from_json(const nlohmann::json &j, ResponseOutputTextDelta &event);
+
+struct ResponseFunctionCallArgumentsDelta {
+  std::string item_id;
+  int output_index;
+  std::string delta;
+};
+
+void from_json(const nlohmann::json &j,
+               ResponseFunctionCallArgumentsDelta &event);
+
+struct ResponseReasoningTextDelta {
+  std::string item_id;
+  int output_index;
+  int content_index;
+  std::string delta;
+};
+
+void from_json(const nlohmann::json &j, ResponseReasoningTextDelta &event);
+
+struct ResponseReasoningSummaryTextDelta {
+  std::string item_id;
+  int output_index;
+  int summary_index;
+  std::string delta;
+};
+
+void from_json(const nlohmann::json &j,
+               ResponseReasoningSummaryTextDelta &event);
+
+struct ResponseCompleted {
+  Response response;
+};
+
+void from_json(const nlohmann::json &j, ResponseCompleted &event);
+
+using ResponseStreamEvent =
+    std::variant<ResponseOutputTextDelta, ResponseFunctionCallArgumentsDelta,
+                 ResponseReasoningTextDelta, ResponseReasoningSummaryTextDelta,
+                 ResponseCompleted>;
+
+} // namespace openrouter
@@ -0,0 +1,102 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace openrouter {
+
+namespace detail {
+
+template <typename T> struct TaskResult {
+  std::optional<T> value;
+
+  void return_value(T result) { value.emplace(std::move(result)); }
+  T take() { return std::move(*value); }
+};
+
+template <> struct TaskResult<void> {
+  void return_void() {}
+  void take() {}
+};
+
+} // namespace detail
+
+// A coroutine that starts when first awaited and resumes its awaiter when
+// it finishes. Top-level tasks are started by PollLoop::run(), or by start()
+// on a loop of the caller's own.
+template <typename T = void> class [[nodiscard]] Task {
+public:
+  struct promise_type : detail::TaskResult<T> {
+    std::exception_ptr error;
+    std::coroutine_handle<> awaiter;
+
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    auto final_suspend() noexcept {
+      struct Final {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+          if (auto awaiter = handle.promise().awaiter) {
+            return awaiter;
+          }
+          return std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+      };
+      return Final{};
+    }
+    void unhandled_exception() { error = std::current_exception(); }
+  };
+
+  Task(Task &&other) noexcept
+      : handle(std::exchange(other.handle, nullptr)) {}
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      if (handle) {
+        handle.destroy();
+      }
+      handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+  }
+  ~Task() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  // Runs the task up to its first suspension without awaiting it. It must
+  // then be kept alive until done() is true.
+  void start() { handle.resume(); }
+  bool done() const { return handle.done(); }
+
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      std::coroutine_handle<promise_type> handle;
+
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) {
+        handle.promise().awaiter = awaiter;
+        return handle;
+      }
+      T await_resume() {
+        if (handle.promise().error) {
+          std::rethrow_exception(handle.promise().error);
+        }
+        return handle.promise().take();
+      }
+    };
+    return Awaiter{handle};
+  }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+} // namespace openrouter
@@ -0,0 +1,75 @@
+#include "openrouter/attachment.hpp"
+#include "openrouter/base64.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace openrouter {
+
+Attachment Attachment::from_bytes(std::span<const std::byte> bytes,
+                                  std::string mime_type) {
+  Attachment attachment;
+  attachment.data = bytes;
+  attachment.mime = std::move(mime_type);
+  return attachment;
+}
+
+Attachment Attachment::from_file(const std::filesystem::path &path,
+                                 std::string mime_type) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error(std::format("Failed to open {}: {}",
+                                         path.string(), std::strerror(errno)));
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::runtime_error(std::format("Failed to stat {}: {}",
+                                         path.string(), std::strerror(error)));
+  }
+
+  Attachment attachment;
+  attachment.mime = std::move(mime_type);
+
+  size_t size = static_cast<size_t>(st.st_size);
+  if (size == 0) {
+    ::close(fd);
+    return attachment;
+  }
+
+  void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  int error = errno;
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error(std::format("Failed to map {}: {}", path.string(),
+                                         std::strerror(error)));
+  }
+
+  ::madvise(mapping, size, MADV_SEQUENTIAL);
+
+  attachment.storage = std::shared_ptr<const void>(
+      mapping, [size](const void *p) { ::munmap(const_cast<void *>(p), size); });
+  attachment.data = {static_cast<const std::byte *>(mapping), size};
+  return attachment;
+}
+
+std::string Attachment::encode(bool data_url) const {
+  std::string prefix;
+  if (data_url && !mime.empty()) {
+    prefix = std::format("data:{};base64,", mime);
+  }
+
+  std::string encoded(prefix.size() + base64_encoded_size(data.size()), '\0');
+  prefix.copy(encoded.data(), prefix.size());
+  base64_encode(data, encoded.data() + prefix.size());
+  return encoded;
+}
+
+} // namespace openrouter
@@ -0,0 +1,406 @@
+#include "openrouter/base64.hpp"
+#include "base64_kernels.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OPENROUTER_BASE64_X86 1
+#endif
+
+namespace openrouter {
+
+static constexpr char alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static constexpr std::array<int8_t, 256> decode_table = [] {
+  std::array<int8_t, 256> table{};
+  table.fill(-1);
+  for (int i = 0; i < 64; ++i) {
+    table[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+  }
+  return table;
+}();
+
+// SIMD kernels handle a prefix of the input and return how much of it they
+// consumed, always a whole number of groups; the scalar code finishes the
+// rest. Encoders consume multiples of 3 bytes, decoders multiples of 4
+// characters and stop early at anything outside the alphabet.
+using EncodeKernel = size_t (*)(const uint8_t *in, size_t size, char *out);
+using DecodeKernel = size_t (*)(const char *in, size_t size, uint8_t *out);
+
+static size_t encode_none(const uint8_t *, size_t, char *) { return 0; }
+static size_t decode_none(const char *, size_t, uint8_t *) { return 0; }
+
+#ifdef OPENROUTER_BASE64_X86
+
+__attribute__((target("ssse3"))) static __m128i
+encode_indices_ssse3(__m128i in) {
+  in = _mm_shuffle_epi8(
+      in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+  __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(t1, t3);
+}
+
+__attribute__((target("ssse3"))) static __m128i
+encode_translate_ssse3(__m128i indices) {
+  __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+  const __m128i shift = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(indices, _mm_shuffle_epi8(shift, result));
+}
+
+__attribute__((target("ssse3"))) static size_t
+encode_ssse3(const uint8_t *in, size_t size, char *out) {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 12) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    v = encode_translate_ssse3(encode_indices_ssse3(v));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), v);
+    out += 16;
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) static size_t
+encode_avx2(const uint8_t *in, size_t size, char *out) {
+  const __m256i shuffle = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5,
+      4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m256i shift = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+  size_t i = 0;
+  for (; i + 28 <= size; i += 24) {
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    __m128i hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 12));
+    __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+    v = _mm256_shuffle_epi8(v, shuffle);
+    __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+    __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+    __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    __m256i indices = _mm256_or_si256(t1, t3);
+
+    __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    result =
+        _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    v = _mm256_add_epi8(indices, _mm256_shuffle_epi8(shift, result));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), v);
+    out += 32;
+  }
+  return i;
+}
+
+// Validation and translation follow the nibble-lookup scheme from
+// Muła and Lemire: a byte is rejected when the low- and high-nibble class
+// masks overlap.
+__attribute__((target("ssse3"))) static size_t
+decode_ssse3(const char *in, size_t size, uint8_t *out) {
+  const __m128i lut_lo =
+      _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m128i lut_hi =
+      _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll =
+      _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask_2f = _mm_set1_epi8(0x2f);
+
+  size_t i = 0;
+  // Each store writes 16 bytes of which 12 are valid; keep enough input in
+  // reserve that the overhang stays inside the output.
+  for (; i + 24 <= size; i += 16) {
+    __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+    __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+    __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    __m128i invalid = _mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128());
+    if (_mm_movemask_epi8(invalid) != 0xFFFF) {
+      break;
+    }
+
+    __m128i eq_2f = _mm_cmpeq_epi8(str, mask_2f);
+    __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+    str = _mm_add_epi8(str, roll);
+
+    __m128i merged = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+    __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+    packed = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+                                                    8, 14, 13, 12, -1, -1, -1,
+                                                    -1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), packed);
+    out += 12;
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) static size_t
+decode_avx2(const char *in, size_t size, uint8_t *out) {
+  const __m256i lut_lo = _mm256_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A,
+      0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m256i lut_hi = _mm256_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4,
+      -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+  const __m256i pack = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5,
+      4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+  size_t i = 0;
+  for (; i + 48 <= size; i += 32) {
+    __m256i str =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+    __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+    __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    if (!_mm256_testz_si256(lo, hi)) {
+      break;
+    }
+
+    __m256i eq_2f = _mm256_cmpeq_epi8(str, mask_2f);
+    __m256i roll =
+        _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+    str = _mm256_add_epi8(str, roll);
+
+    __m256i merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+    __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+    packed = _mm256_shuffle_epi8(packed, pack);
+    packed = _mm256_permutevar8x32_epi32(
+        packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), packed);
+    out += 24;
+  }
+  return i;
+}
+
+#endif
+
+struct Kernels {
+  EncodeKernel encode;
+  DecodeKernel decode;
+};
+
+static bool supported(Base64Kernels kernels) {
+  switch (kernels) {
+  case Base64Kernels::Scalar:
+    return true;
+#ifdef OPENROUTER_BASE64_X86
+  case Base64Kernels::SSSE3:
+    return __builtin_cpu_supports("ssse3");
+  case Base64Kernels::AVX2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+static Kernels kernels_for(Base64Kernels kernels) {
+  switch (kernels) {
+#ifdef OPENROUTER_BASE64_X86
+  case Base64Kernels::SSSE3:
+    return {encode_ssse3, decode_ssse3};
+  case Base64Kernels::AVX2:
+    return {encode_avx2, decode_avx2};
+#endif
+  default:
+    return {encode_none, decode_none};
+  }
+}
+
+static Kernels &kernels() {
+  static Kernels kernels = [] {
+    for (auto widest : {Base64Kernels::AVX2, Base64Kernels::SSSE3}) {
+      if (supported(widest)) {
+        return kernels_for(widest);
+      }
+    }
+    return kernels_for(Base64Kernels::Scalar);
+  }();
+  return kernels;
+}
+
+bool use_base64_kernels(Base64Kernels kernels) {
+  if (!supported(kernels)) {
+    return false;
+  }
+  openrouter::kernels() = kernels_for(kernels);
+  return true;
+}
+
+static std::string_view strip_padding(std::string_view encoded) {
+  if (encoded.size() % 4 == 0) {
+    for (int i = 0; i < 2 && !encoded.empty() && encoded.back() == '='; ++i) {
+      encoded.remove_suffix(1);
+    }
+  }
+  return encoded;
+}
+
+size_t base64_decoded_size(std::string_view encoded) {
+  encoded = strip_padding(encoded);
+  return encoded.size() / 4 * 3 + (encoded.size() % 4 * 3) / 4;
+}
+
+void base64_encode(std::span<const std::byte> in, char *out) {
+  auto data = reinterpret_cast<const uint8_t *>(in.data());
+  size_t size = in.size();
+
+  size_t i = kernels().encode(data, size, out);
+  out += i / 3 * 4;
+
+  for (; i + 3 <= size; i += 3) {
+    uint32_t group = data[i] << 16 | data[i + 1] << 8 | data[i + 2];
+    *out++ = alphabet[group >> 18];
+    *out++ = alphabet[(group >> 12) & 0x3F];
+    *out++ = alphabet[(group >> 6) & 0x3F];
+    *out++ = alphabet[group & 0x3F];
+  }
+
+  if (size - i == 1) {
+    uint32_t group = data[i] << 16;
+    *out++ = alphabet[group >> 18];
+    *out++ = alphabet[(group >> 12) & 0x3F];
+    *out++ = '=';
+    *out++ = '=';
+  } else if (size - i == 2) {
+    uint32_t group = data[i] << 16 | data[i + 1] << 8;
+    *out++ = alphabet[group >> 18];
+    *out++ = alphabet[(group >> 12) & 0x3F];
+    *out++ = alphabet[(group >> 6) & 0x3F];
+    *out++ = '=';
+  }
+}
+
+std::string base64_encode(std::span<const std::byte> in) {
+  std::string out(base64_encoded_size(in.size()), '\0');
+  base64_encode(in, out.data());
+  return out;
+}
+
+size_t base64_decode(std::string_view in, std::span<std::byte> out) {
+  in = strip_padding(in);
+  if (in.size() % 4 == 1) {
+    throw std::runtime_error("Invalid base64 length");
+  }
+
+  size_t decoded_size = in.size() / 4 * 3 + (in.size() % 4 * 3) / 4;
+  if (out.size() < decoded_size) {
+    throw std::runtime_error(std::format(
+        "base64 output buffer too small: need {}, have {}", decoded_size,
+        out.size()));
+  }
+
+  auto dest = reinterpret_cast<uint8_t *>(out.data());
+  size_t i = kernels().decode(in.data(), in.size(), dest);
+  dest += i / 4 * 3;
+
+  uint32_t group = 0;
+  int bits = 0;
+  for (; i < in.size(); ++i) {
+    int8_t value = decode_table[static_cast<unsigned char>(in[i])];
+    if (value < 0) {
+      throw std::runtime_error(
+          std::format("Invalid base64 character at offset {}", i));
+    }
+
+    group = group << 6 | static_cast<uint32_t>(value);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      *dest++ = static_cast<uint8_t>(group >> bits);
+    }
+  }
+
+  return decoded_size;
+}
+
+std::vector<std::byte> base64_decode(std::string_view in) {
+  std::vector<std::byte> out(base64_decoded_size(in));
+  base64_decode(in, out);
+  return out;
+}
+
+static std::string data_url(std::string_view mime_type,
+                            std::span<const std::byte> bytes) {
+  std::string prefix = std::format("data:{};base64,", mime_type);
+  std::string url(prefix.size() + base64_encoded_size(bytes.size()), '\0');
+  prefix.copy(url.data(), prefix.size());
+  base64_encode(bytes, url.data() + prefix.size());
+  return url;
+}
+
+InputFile make_input_file(std::span<const std::byte> bytes,
+                          std::string filename, std::string_view mime_type) {
+  InputFile file;
+  file.data = data_url(mime_type, bytes);
+  file.filename = std::move(filename);
+  return file;
+}
+
+InputImage make_input_image(std::span<const std::byte> bytes,
+                            std::string_view mime_type,
+                            InputImage::Detail detail) {
+  InputImage image;
+  image.detail = detail;
+  image.url = data_url(mime_type, bytes);
+  return image;
+}
+
+InputAudio make_input_audio(std::span<const std::byte> bytes,
+                            InputAudio::Format format) {
+  InputAudio audio;
+  audio.format = format;
+  audio.data = base64_encode(bytes);
+  return audio;
+}
+
+static std::string_view image_payload(const ResponsesImageGenerationCall &call) {
+  if (!call.result) {
+    return {};
+  }
+
+  std::string_view payload = *call.result;
+  if (payload.starts_with("data:")) {
+    auto comma = payload.find(',');
+    payload = comma == std::string_view::npos ? std::string_view()
+                                              : payload.substr(comma + 1);
+  }
+  return payload;
+}
+
+size_t image_result_size(const ResponsesImageGenerationCall &call) {
+  return base64_decoded_size(image_payload(call));
+}
+
+size_t decode_image_result(const ResponsesImageGenerationCall &call,
+                           std::span<std::byte> out) {
+  return base64_decode(image_payload(call), out);
+}
+
+} // namespace openrouter
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace openrouter {
+
+// The instruction sets the base64 codec can use for its bulk loop. The
+// widest the CPU supports is picked on first use.
+enum class Base64Kernels {
+  Scalar,
+  SSSE3,
+  AVX2,
+};
+
+// Switches the codec to `kernels`, for tests that compare them with the
+// scalar path. Returns false, changing nothing, when the CPU lacks them. Not
+// safe while other threads use the codec.
+bool use_base64_kernels(Base64Kernels kernels);
+
+} // namespace openrouter
@@ -0,0 +1,487 @@
+#include "cache.hpp"
+#include "request_body.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace openrouter {
+
+namespace {
+
+// Two independent multiply-mix lanes over 8-byte words. Not cryptographic,
+// but 128 bits keep accidental collisions out of reach.
+class KeyHasher {
+public:
+  void update(std::string_view data) {
+    length += data.size();
+    if (tail_size > 0) {
+      std::size_t n = std::min(data.size(), sizeof(tail) - tail_size);
+      std::memcpy(tail + tail_size, data.data(), n);
+      tail_size += n;
+      data.remove_prefix(n);
+      if (tail_size < sizeof(tail)) {
+        return;
+      }
+      mix(load(tail));
+      tail_size = 0;
+    }
+
+    while (data.size() >= sizeof(std::uint64_t)) {
+      mix(load(data.data()));
+      data.remove_prefix(sizeof(std::uint64_t));
+    }
+    std::memcpy(tail, data.data(), data.size());
+    tail_size = data.size();
+  }
+
+  CacheKey finish() {
+    std::memset(tail + tail_size, 0, sizeof(tail) - tail_size);
+    mix(load(tail));
+    mix(length);
+    return {fmix(a ^ std::rotl(b, 17)), fmix(b ^ std::rotl(a, 41))};
+  }
+
+private:
+  static std::uint64_t load(const char *data) {
+    std::uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+  }
+
+  static std::uint64_t fmix(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccd;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53;
+    h ^= h >> 33;
+    return h;
+  }
+
+  void mix(std::uint64_t word) {
+    a = std::rotl((a ^ word) * 0x9e3779b97f4a7c15, 29);
+    b = std::rotl(b + word, 31) * 0xc2b2ae3d27d4eb4f;
+  }
+
+  std::uint64_t a = 0x243f6a8885a308d3;
+  std::uint64_t b = 0x13198a2e03707344;
+  std::uint64_t length = 0;
+  char tail[8];
+  std::size_t tail_size = 0;
+};
+
+struct KeyHash {
+  std::size_t operator()(const CacheKey &key) const { return key.lo; }
+};
+
+// Writes all of `data` at `offset`, or returns false.
+bool write_at(int fd, std::string_view data, std::uint64_t offset) {
+  std::size_t done = 0;
+  while (done < data.size()) {
+    ssize_t n = ::pwrite(fd, data.data() + done, data.size() - done,
+                         static_cast<off_t>(offset + done));
+    if (n <= 0) {
+      return false;
+    }
+    done += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+[[noreturn]] void throw_errno(std::string_view what,
+                              const std::filesystem::path &path) {
+  throw std::runtime_error(std::format("Response cache: cannot {} {}: {}",
+                                       what, path.string(),
+                                       std::strerror(errno)));
+}
+
+} // namespace
+
+struct ResponseCache::Shard {
+  using Entry = std::pair<CacheKey, std::shared_ptr<const std::string>>;
+
+  std::mutex mutex;
+  // Most recently used first.
+  std::list<Entry> lru;
+  std::unordered_map<CacheKey, std::list<Entry>::iterator, KeyHash> index;
+  std::size_t bytes = 0;
+};
+
+// An append-only file of raw bodies plus a memory-mapped open-addressing
+// index of (key, offset, length) slots. The index header records how much
+// of the data file is committed, and a body is synced before its slot is
+// filled, so an append torn by a crash or power loss is simply overwritten
+// after a restart. An exclusive lock on the index keeps out other clients. Bodies are never removed one by one; once the
+// file reaches its bound, compaction drops the oldest of them at once.
+class ResponseCache::Disk {
+public:
+  Disk(const std::filesystem::path &directory, std::uint64_t max_bytes);
+  ~Disk();
+
+  std::optional<std::string> get(const CacheKey &key);
+  void put(const CacheKey &key, std::string_view body);
+
+private:
+  struct Header {
+    std::uint64_t magic;
+    std::uint64_t capacity;
+    std::uint64_t count;
+    std::uint64_t data_size;
+  };
+
+  // A zero length marks a free slot.
+  struct Slot {
+    CacheKey key;
+    std::uint64_t offset;
+    std::uint64_t length;
+  };
+
+  // "ORCACHE1" as stored on a little-endian host.
+  static constexpr std::uint64_t magic = 0x314548434143524f;
+  static constexpr std::uint64_t initial_capacity = 1024;
+
+  static std::size_t index_size(std::uint64_t capacity) {
+    return sizeof(Header) + capacity * sizeof(Slot);
+  }
+
+  Header &header() { return *static_cast<Header *>(mapping); }
+  Slot *slots() {
+    return reinterpret_cast<Slot *>(static_cast<char *>(mapping) +
+                                    sizeof(Header));
+  }
+
+  bool valid();
+  void map(std::size_t size);
+  void reset(std::uint64_t capacity);
+  Slot &find(const CacheKey &key);
+  void grow();
+  void compact(std::uint64_t keep);
+
+  std::filesystem::path index_path;
+  std::uint64_t max_bytes;
+  std::mutex mutex;
+  int data_fd = -1;
+  int index_fd = -1;
+  void *mapping = nullptr;
+  std::size_t mapping_size = 0;
+};
+
+ResponseCache::Disk::Disk(const std::filesystem::path &directory,
+                          std::uint64_t max_bytes)
+    : index_path(directory / "responses.index"), max_bytes(max_bytes) {
+  std::filesystem::create_directories(directory);
+
+  auto data_path = directory / "responses.data";
+  data_fd = ::open(data_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (data_fd < 0) {
+    throw_errno("open", data_path);
+  }
+  index_fd = ::open(index_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (index_fd < 0) {
+    ::close(data_fd);
+    throw_errno("open", index_path);
+  }
+  // Held until the index is closed, including by a crash.
+  if (::flock(index_fd, LOCK_EX | LOCK_NB) != 0) {
+    int error = errno;
+    ::close(index_fd);
+    ::close(data_fd);
+    if (error == EWOULDBLOCK) {
+      throw std::runtime_error(std::format(
+          "Response cache: {} is in use by another client",
+          directory.string()));
+    }
+    errno = error;
+    throw_errno("lock", index_path);
+  }
+
+  struct stat info;
+  if (::fstat(index_fd, &info) == 0 &&
+      static_cast<std::size_t>(info.st_size) >= sizeof(Header)) {
+    map(info.st_size);
+    if (valid()) {
+      return;
+    }
+  }
+  reset(initial_capacity);
+}
+
+ResponseCache::Disk::~Disk() {
+  if (mapping) {
+    ::munmap(mapping, mapping_size);
+  }
+  ::close(index_fd);
+  ::close(data_fd);
+}
+
+bool ResponseCache::Disk::valid() {
+  const Header &h = header();
+  return h.magic == magic && std::has_single_bit(h.capacity) &&
+         index_size(h.capacity) == mapping_size && h.count < h.capacity;
+}
+
+void ResponseCache::Disk::map(std::size_t size) {
+  if (mapping) {
+    ::munmap(mapping, mapping_size);
+    mapping = nullptr;
+  }
+  if (::ftruncate(index_fd, static_cast<off_t>(size)) != 0) {
+    throw_errno("resize", index_path);
+  }
+  void *address =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd, 0);
+  if (address == MAP_FAILED) {
+    throw_errno("map", index_path);
+  }
+  mapping = address;
+  mapping_size = size;
+}
+
+void ResponseCache::Disk::reset(std::uint64_t capacity) {
+  map(index_size(capacity));
+  std::memset(mapping, 0, mapping_size);
+  header() = {magic, capacity, 0, 0};
+}
+
+ResponseCache::Disk::Slot &ResponseCache::Disk::find(const CacheKey &key) {
+  std::uint64_t mask = header().capacity - 1;
+  Slot *table = slots();
+  for (std::uint64_t i = key.lo & mask;; i = (i + 1) & mask) {
+    if (table[i].length == 0 || table[i].key == key) {
+      return table[i];
+    }
+  }
+}
+
+// Doubles the table once it is half full, keeping probe runs short.
+void ResponseCache::Disk::grow() {
+  Header old = header();
+  std::vector<Slot> used;
+  used.reserve(old.count);
+  std::copy_if(slots(), slots() + old.capacity, std::back_inserter(used),
+               [](const Slot &slot) { return slot.length != 0; });
+
+  reset(old.capacity * 2);
+  for (const Slot &slot : used) {
+    find(slot.key) = slot;
+  }
+  header().count = old.count;
+  header().data_size = old.data_size;
+}
+
+// Keeps the newest bodies, at most `keep` bytes of them, and moves them to
+// the front of the data file. Bodies are laid end to end in the order they
+// were added, so the survivors are one contiguous run. The index is emptied
+// on disk before any body moves: a crash part way through loses the tier
+// rather than pointing slots at the wrong bytes.
+void ResponseCache::Disk::compact(std::uint64_t keep) {
+  Header old = header();
+  std::uint64_t cutoff = old.data_size > keep ? old.data_size - keep : 0;
+  std::vector<Slot> kept;
+  std::copy_if(slots(), slots() + old.capacity, std::back_inserter(kept),
+               [cutoff](const Slot &slot) {
+                 return slot.length != 0 && slot.offset >= cutoff;
+               });
+  std::uint64_t start = old.data_size;
+  for (const Slot &slot : kept) {
+    start = std::min(start, slot.offset);
+  }
+
+  std::fill_n(slots(), old.capacity, Slot{});
+  header().count = 0;
+  header().data_size = 0;
+  ::msync(mapping, mapping_size, MS_SYNC);
+
+  char buffer[64 * 1024];
+  for (std::uint64_t from = start; from < old.data_size;) {
+    std::size_t size = std::min<std::uint64_t>(sizeof(buffer),
+                                               old.data_size - from);
+    ssize_t n = ::pread(data_fd, buffer, size, static_cast<off_t>(from));
+    if (n <= 0) {
+      return;
+    }
+    std::string_view chunk(buffer, static_cast<std::size_t>(n));
+    if (!write_at(data_fd, chunk, from - start)) {
+      return;
+    }
+    from += chunk.size();
+  }
+  if (::fdatasync(data_fd) != 0) {
+    return;
+  }
+  // Only hands the space back; bytes past data_size are never read.
+  [[maybe_unused]] int truncated =
+      ::ftruncate(data_fd, static_cast<off_t>(old.data_size - start));
+
+  for (Slot slot : kept) {
+    slot.offset -= start;
+    find(slot.key) = slot;
+  }
+  header().count = kept.size();
+  header().data_size = old.data_size - start;
+}
+
+std::optional<std::string> ResponseCache::Disk::get(const CacheKey &key) {
+  std::lock_guard lock(mutex);
+  const Slot &slot = find(key);
+  if (slot.length == 0) {
+    return std::nullopt;
+  }
+
+  std::string body(slot.length, '\0');
+  std::size_t done = 0;
+  while (done < body.size()) {
+    ssize_t n = ::pread(data_fd, body.data() + done, body.size() - done,
+                        static_cast<off_t>(slot.offset + done));
+    if (n <= 0) {
+      return std::nullopt;
+    }
+    done += static_cast<std::size_t>(n);
+  }
+  return body;
+}
+
+void ResponseCache::Disk::put(const CacheKey &key, std::string_view body) {
+  if (body.empty() || body.size() > max_bytes) {
+    return;
+  }
+
+  std::lock_guard lock(mutex);
+  if (find(key).length != 0) {
+    return;
+  }
+  if ((header().count + 1) * 2 > header().capacity) {
+    grow();
+  }
+  if (header().data_size + body.size() > max_bytes) {
+    compact(std::min(max_bytes / 2, max_bytes - body.size()));
+  }
+
+  // The slot is only filled once the body is on disk.
+  std::uint64_t offset = header().data_size;
+  if (!write_at(data_fd, body, offset) || ::fdatasync(data_fd) != 0) {
+    return;
+  }
+
+  find(key) = {key, offset, body.size()};
+  header().data_size += body.size();
+  ++header().count;
+}
+
+ResponseCache::ResponseCache(const CachePolicy &policy) : policy(policy) {
+  this->policy.shards = std::max<std::size_t>(1, policy.shards);
+  shards = std::make_unique<Shard[]>(this->policy.shards);
+  if (policy.enabled && !policy.directory.empty()) {
+    disk = std::make_unique<Disk>(policy.directory, policy.max_disk_bytes);
+  }
+}
+
+ResponseCache::~ResponseCache() = default;
+
+CacheKey ResponseCache::key(RequestBody &body) {
+  KeyHasher hasher;
+  if (body.contiguous()) {
+    hasher.update(body.text());
+    return hasher.finish();
+  }
+
+  char buffer[64 * 1024];
+  body.rewind();
+  while (std::size_t n = body.read(buffer, sizeof(buffer))) {
+    hasher.update(std::string_view(buffer, n));
+  }
+  body.rewind();
+  return hasher.finish();
+}
+
+ResponseCache::Shard &ResponseCache::shard(const CacheKey &key) {
+  return shards[key.hi % policy.shards];
+}
+
+std::shared_ptr<const std::string> ResponseCache::get(const CacheKey &key) {
+  {
+    Shard &shard = this->shard(key);
+    std::lock_guard lock(shard.mutex);
+    if (auto it = shard.index.find(key); it != shard.index.end()) {
+      shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+      ++hits;
+      return it->second->second;
+    }
+  }
+
+  if (disk) {
+    if (auto body = disk->get(key)) {
+      auto shared = std::make_shared<const std::string>(std::move(*body));
+      remember(key, shared);
+      ++disk_hits;
+      return shared;
+    }
+  }
+
+  ++misses;
+  return nullptr;
+}
+
+void ResponseCache::put(const CacheKey &key, std::string body) {
+  auto shared = std::make_shared<const std::string>(std::move(body));
+  if (disk) {
+    disk->put(key, *shared);
+  }
+  remember(key, std::move(shared));
+}
+
+void ResponseCache::remember(const CacheKey &key,
+                             std::shared_ptr<const std::string> body) {
+  std::size_t budget = policy.max_bytes / policy.shards;
+  if (body->size() > budget) {
+    return;
+  }
+
+  Shard &shard = this->shard(key);
+  std::lock_guard lock(shard.mutex);
+  if (shard.index.contains(key)) {
+    return;
+  }
+
+  shard.bytes += body->size();
+  shard.lru.emplace_front(key, std::move(body));
+  shard.index.emplace(key, shard.lru.begin());
+
+  while (shard.bytes > budget) {
+    auto &[evicted, evicted_body] = shard.lru.back();
+    shard.bytes -= evicted_body->size();
+    shard.index.erase(evicted);
+    shard.lru.pop_back();
+    ++evictions;
+  }
+}
+
+CacheStats ResponseCache::stats() const {
+  CacheStats stats;
+  stats.hits = hits;
+  stats.disk_hits = disk_hits;
+  stats.misses = misses;
+  stats.evictions = evictions;
+  for (std::size_t i = 0; i < policy.shards; ++i) {
+    std::lock_guard lock(shards[i].mutex);
+    stats.entries += shards[i].index.size();
+    stats.bytes += shards[i].bytes;
+  }
+  return stats;
+}
+
+} // namespace openrouter
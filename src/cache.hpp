@@ -0,0 +1,53 @@
+#pragma once
+#include "openrouter/cache.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace openrouter {
+
+class RequestBody;
+
+struct CacheKey {
+  std::uint64_t lo = 0;
+  std::uint64_t hi = 0;
+
+  bool operator==(const CacheKey &) const = default;
+};
+
+// The two tiers behind CachePolicy. Values are raw response bodies, decoded
+// again on every hit so they serve both Response and pmr::Response.
+// Thread-safe.
+class ResponseCache {
+public:
+  explicit ResponseCache(const CachePolicy &policy);
+  ~ResponseCache();
+
+  bool enabled() const { return policy.enabled; }
+
+  // 128-bit hash of the body as sent, attachments included.
+  static CacheKey key(RequestBody &body);
+
+  std::shared_ptr<const std::string> get(const CacheKey &key);
+  void put(const CacheKey &key, std::string body);
+
+  CacheStats stats() const;
+
+private:
+  struct Shard;
+  class Disk;
+
+  Shard &shard(const CacheKey &key);
+  void remember(const CacheKey &key, std::shared_ptr<const std::string> body);
+
+  CachePolicy policy;
+  std::unique_ptr<Shard[]> shards;
+  std::unique_ptr<Disk> disk;
+  std::atomic<std::uint64_t> hits = 0;
+  std::atomic<std::uint64_t> disk_hits = 0;
+  std::atomic<std::uint64_t> misses = 0;
+  std::atomic<std::uint64_t> evictions = 0;
+};
+
+} // namespace openrouter
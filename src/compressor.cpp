@@ -0,0 +1,110 @@
+#include "compressor.hpp"
+#include "request_body.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <zlib.h>
+
+namespace openrouter {
+
+using Clock = std::chrono::steady_clock;
+
+Compressor::Compressor(const CompressionPolicy &policy,
+                       const curl_slist *headers)
+    : policy(policy) {
+  for (auto item = headers; item; item = item->next) {
+    gzip_headers = curl_slist_append(gzip_headers, item->data);
+  }
+  gzip_headers = curl_slist_append(gzip_headers, "Content-Encoding: gzip");
+}
+
+Compressor::~Compressor() { curl_slist_free_all(gzip_headers); }
+
+// Reads the whole body, attachments encoded on the way, through deflate.
+static std::string gzip(RequestBody &body, int level) {
+  z_stream stream{};
+  // 16 on top of the window bits selects the gzip wrapper.
+  if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw std::runtime_error("Failed to initialize zlib");
+  }
+
+  std::string out(deflateBound(&stream, body.size()), '\0');
+  stream.next_out = reinterpret_cast<Bytef *>(out.data());
+  stream.avail_out = static_cast<uInt>(out.size());
+
+  char chunk[64 * 1024];
+  body.rewind();
+  int flush = Z_NO_FLUSH;
+  int res = Z_OK;
+  while (res != Z_STREAM_END) {
+    if (stream.avail_in == 0 && flush == Z_NO_FLUSH) {
+      size_t n = body.read(chunk, sizeof(chunk));
+      stream.next_in = reinterpret_cast<Bytef *>(chunk);
+      stream.avail_in = static_cast<uInt>(n);
+      if (n < sizeof(chunk)) {
+        flush = Z_FINISH;
+      }
+    }
+    if (stream.avail_out == 0) {
+      size_t used = out.size();
+      out.resize(used * 2);
+      stream.next_out = reinterpret_cast<Bytef *>(out.data() + used);
+      stream.avail_out = static_cast<uInt>(out.size() - used);
+    }
+    res = deflate(&stream, flush);
+    if (res == Z_STREAM_ERROR) {
+      deflateEnd(&stream);
+      throw std::runtime_error("zlib failed to compress the request body");
+    }
+  }
+
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  body.rewind();
+  return out;
+}
+
+Clock::duration Compressor::compress(RequestBody &body) {
+  if (!policy.compress_requests) {
+    return {};
+  }
+  size_t size = body.size();
+  if (size < policy.min_size) {
+    return {};
+  }
+
+  auto started = Clock::now();
+  std::string encoded = gzip(body, std::clamp(policy.level, 1, 9));
+  bool smaller = encoded.size() < size;
+  if (smaller) {
+    body.clear();
+    body.text() = std::move(encoded);
+    body.set_headers(gzip_headers);
+  }
+  auto elapsed = Clock::now() - started;
+
+  if (smaller) {
+    compressed.fetch_add(1, std::memory_order_relaxed);
+    bytes_in.fetch_add(size, std::memory_order_relaxed);
+    bytes_out.fetch_add(body.size(), std::memory_order_relaxed);
+  } else {
+    skipped.fetch_add(1, std::memory_order_relaxed);
+  }
+  micros.fetch_add(
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(),
+      std::memory_order_relaxed);
+  return elapsed;
+}
+
+CompressionStats Compressor::stats() const {
+  CompressionStats stats;
+  stats.compressed = compressed;
+  stats.skipped = skipped;
+  stats.bytes_in = bytes_in;
+  stats.bytes_out = bytes_out;
+  stats.time = std::chrono::microseconds(micros.load());
+  return stats;
+}
+
+} // namespace openrouter
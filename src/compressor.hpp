@@ -0,0 +1,39 @@
+#pragma once
+#include "openrouter/compression.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <curl/curl.h>
+
+namespace openrouter {
+
+class RequestBody;
+
+// Request side of CompressionPolicy. Thread-safe.
+class Compressor {
+public:
+  // `headers` are the client's defaults; compressed bodies are sent with a
+  // copy that adds Content-Encoding.
+  Compressor(const CompressionPolicy &policy, const curl_slist *headers);
+  ~Compressor();
+
+  Compressor(const Compressor &) = delete;
+  Compressor &operator=(const Compressor &) = delete;
+
+  // Replaces `body` with its gzip form if the policy asks for it and that
+  // is smaller. Returns the time spent.
+  std::chrono::steady_clock::duration compress(RequestBody &body);
+
+  CompressionStats stats() const;
+
+private:
+  CompressionPolicy policy;
+  curl_slist *gzip_headers = nullptr;
+  std::atomic<std::uint64_t> compressed = 0;
+  std::atomic<std::uint64_t> skipped = 0;
+  std::atomic<std::uint64_t> bytes_in = 0;
+  std::atomic<std::uint64_t> bytes_out = 0;
+  std::atomic<std::int64_t> micros = 0;
+};
+
+} // namespace openrouter
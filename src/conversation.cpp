@@ -0,0 +1,98 @@
+#include "openrouter/responses.hpp"
+#include "json_writer.hpp"
+#include <utility>
+
+namespace openrouter {
+
+struct Conversation::Encoded {
+  RequestBody items;
+  // Where each item ends in `items`.
+  std::vector<RequestBody::Mark> ends;
+};
+
+Conversation::Conversation() : encoded(std::make_unique<Encoded>()) {}
+
+// A moved-from conversation is left empty, without an encoding until its
+// next append.
+Conversation::Conversation(const Conversation &other)
+    : items(other.items),
+      encoded(other.encoded ? std::make_unique<Encoded>(*other.encoded)
+                            : std::make_unique<Encoded>()) {}
+
+Conversation::Conversation(Conversation &&other) noexcept
+    : items(std::exchange(other.items, {})),
+      encoded(std::move(other.encoded)) {}
+
+Conversation &Conversation::operator=(const Conversation &other) {
+  if (this != &other) {
+    *this = Conversation(other);
+  }
+  return *this;
+}
+
+Conversation &Conversation::operator=(Conversation &&other) noexcept {
+  items = std::exchange(other.items, {});
+  encoded = std::move(other.encoded);
+  return *this;
+}
+
+Conversation::~Conversation() = default;
+
+void Conversation::append(std::string text) {
+  append(OpenResponsesEasyInputMessage{OpenResponsesEasyInputMessage::User,
+                                       {InputText{std::move(text)}}});
+}
+
+void Conversation::append(OpenResponsesInput item) {
+  if (!encoded) {
+    encoded = std::make_unique<Encoded>();
+  }
+  auto &body = encoded->items;
+  auto end = body.end();
+  try {
+    if (!items.empty()) {
+      body.text().push_back(',');
+    }
+    JsonWriter w(body);
+    write(w, item);
+  } catch (...) {
+    body.truncate(end);
+    throw;
+  }
+  encoded->ends.push_back(body.end());
+  items.push_back(std::move(item));
+}
+
+void Conversation::append(const Response &response) {
+  if (!response.output) {
+    return;
+  }
+  // A turn is appended whole or not at all.
+  auto size = items.size();
+  try {
+    for (const auto &item : *response.output) {
+      std::visit([this](const auto &arg) { append(OpenResponsesInput(arg)); },
+                 item);
+    }
+  } catch (...) {
+    truncate(size);
+    throw;
+  }
+}
+
+void Conversation::truncate(std::size_t size) {
+  if (size >= items.size()) {
+    return;
+  }
+  items.erase(items.begin() + size, items.end());
+  encoded->ends.resize(size);
+  encoded->items.truncate(size ? encoded->ends.back()
+                               : RequestBody::Mark{1, 0});
+}
+
+const RequestBody &Conversation::items_body() const {
+  static const RequestBody empty;
+  return encoded ? encoded->items : empty;
+}
+
+} // namespace openrouter
@@ -0,0 +1,379 @@
+#include "engine.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace openrouter {
+
+static void run_tasks(std::vector<Engine::Task> &tasks, bool aborted) {
+  for (auto &task : tasks) {
+    try {
+      task(aborted);
+    } catch (...) {
+    }
+  }
+}
+
+Engine::Engine(const ConnectionPolicy &policy, EventLoop *loop) : loop(loop) {
+  multi = curl_multi_init();
+  multiplex = policy.http_version != HttpVersion::Http1;
+  if (multiplex) {
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi, CURLMOPT_MAX_CONCURRENT_STREAMS,
+                      policy.max_concurrent_streams);
+  } else {
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_NOTHING);
+  }
+  curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                    policy.max_host_connections);
+  curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, policy.max_idle_connections);
+
+  if (!loop) {
+    thread = std::thread([this] { run(); });
+    return;
+  }
+
+  self = std::make_shared<Engine *>(this);
+  weak_self = self;
+  curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, on_socket);
+  curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this);
+  curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, on_timer);
+  curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this);
+}
+
+Engine::~Engine() {
+  if (!loop) {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+    curl_multi_wakeup(multi);
+    thread.join();
+    curl_multi_cleanup(multi);
+    return;
+  }
+
+  self.reset();
+  Queue incoming;
+  std::vector<Task> dropped;
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+    incoming.swap(pending);
+    for (auto &[when, task] : timers) {
+      dropped.push_back(std::move(task));
+    }
+    timers.clear();
+  }
+  halt(std::move(incoming));
+  run_tasks(dropped, true);
+  if (timer) {
+    loop->cancel_timer(timer->second);
+  }
+  curl_multi_cleanup(multi);
+  for (curl_socket_t fd : watched) {
+    loop->unwatch(fd);
+  }
+}
+
+void Engine::submit(std::unique_ptr<Transfer> transfer,
+                    Clock::duration delay) {
+  {
+    std::lock_guard lock(mutex);
+    pending.emplace_back(Clock::now() + delay, std::move(transfer));
+  }
+  notify();
+}
+
+void Engine::schedule(Clock::duration delay, Task task) {
+  {
+    std::lock_guard lock(mutex);
+    if (!stopping) {
+      timers.emplace(Clock::now() + delay, std::move(task));
+      task = nullptr;
+    }
+  }
+  if (task) {
+    task(true);
+    return;
+  }
+  notify();
+}
+
+void Engine::start(std::unique_ptr<Transfer> transfer) {
+  CURL *handle = transfer->handle.get();
+  if (multiplex) {
+    // Wait for a connection still being set up to learn whether it can take
+    // another stream, rather than racing it with a new one. Synchronous
+    // calls must not: the connection they would wait on belongs to another
+    // thread, which never tells them it is free.
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+  }
+  CURLMcode res = curl_multi_add_handle(multi, handle);
+  if (res != CURLM_OK) {
+    complete(std::move(transfer), CURLE_FAILED_INIT);
+    return;
+  }
+  active.emplace(handle, std::move(transfer));
+}
+
+void Engine::cancel(CURL *handle) {
+  auto owns = [handle](const auto &entry) {
+    return entry.second->handle.get() == handle;
+  };
+
+  std::unique_ptr<Transfer> transfer;
+  if (auto it = active.find(handle); it != active.end()) {
+    curl_multi_remove_handle(multi, handle);
+    transfer = std::move(it->second);
+    active.erase(it);
+  } else if (auto it = std::ranges::find_if(delayed, owns);
+             it != delayed.end()) {
+    transfer = std::move(it->second);
+    delayed.erase(it);
+  } else {
+    std::lock_guard lock(mutex);
+    auto queued = std::ranges::find_if(pending, owns);
+    if (queued == pending.end()) {
+      return;
+    }
+    transfer = std::move(queued->second);
+    pending.erase(queued);
+  }
+  complete(std::move(transfer), CURLE_ABORTED_BY_CALLBACK);
+}
+
+void Engine::run() {
+  while (dispatch()) {
+    int running = 0;
+    curl_multi_perform(multi, &running);
+    collect();
+
+    auto next =
+        std::min(next_wakeup(), Clock::now() + std::chrono::seconds(1));
+    auto wait =
+        std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now());
+    int timeout_ms = static_cast<int>(
+        std::max<std::chrono::milliseconds::rep>(wait.count(), 0));
+    curl_multi_poll(multi, nullptr, 0, timeout_ms, nullptr);
+  }
+}
+
+bool Engine::dispatch() {
+  Queue incoming;
+  std::vector<Task> due;
+  bool stop;
+  {
+    std::lock_guard lock(mutex);
+    incoming.swap(pending);
+    stop = stopping;
+    notified = false;
+
+    auto now = Clock::now();
+    while (!timers.empty() && timers.begin()->first <= now) {
+      due.push_back(std::move(timers.begin()->second));
+      timers.erase(timers.begin());
+    }
+    if (stop) {
+      for (auto &[when, task] : timers) {
+        due.push_back(std::move(task));
+      }
+      timers.clear();
+    }
+  }
+
+  if (stop) {
+    halt(std::move(incoming));
+    run_tasks(due, true);
+    return false;
+  }
+
+  auto now = Clock::now();
+  std::vector<std::unique_ptr<Transfer>> ready;
+  for (auto &[when, transfer] : incoming) {
+    if (when > now) {
+      delayed.emplace(when, std::move(transfer));
+    } else {
+      ready.push_back(std::move(transfer));
+    }
+  }
+  while (!delayed.empty() && delayed.begin()->first <= now) {
+    ready.push_back(std::move(delayed.begin()->second));
+    delayed.erase(delayed.begin());
+  }
+
+  for (auto &transfer : ready) {
+    start(std::move(transfer));
+  }
+  run_tasks(due, false);
+  return true;
+}
+
+void Engine::collect() {
+  int queued = 0;
+  while (CURLMsg *msg = curl_multi_info_read(multi, &queued)) {
+    if (msg->msg != CURLMSG_DONE) {
+      continue;
+    }
+
+    CURL *handle = msg->easy_handle;
+    CURLcode result = msg->data.result;
+
+    // A completion callback may already have cancelled this one.
+    auto it = active.find(handle);
+    if (it == active.end()) {
+      continue;
+    }
+
+    curl_multi_remove_handle(multi, handle);
+    auto transfer = std::move(it->second);
+    active.erase(it);
+    complete(std::move(transfer), result);
+  }
+}
+
+void Engine::halt(Queue incoming) {
+  halted = true;
+  for (auto &[when, transfer] : incoming) {
+    complete(std::move(transfer), CURLE_ABORTED_BY_CALLBACK);
+  }
+  for (auto &[when, transfer] : delayed) {
+    complete(std::move(transfer), CURLE_ABORTED_BY_CALLBACK);
+  }
+  auto remaining = std::move(active);
+  active.clear();
+  for (auto &[handle, transfer] : remaining) {
+    curl_multi_remove_handle(multi, handle);
+    complete(std::move(transfer), CURLE_ABORTED_BY_CALLBACK);
+  }
+}
+
+Engine::Clock::time_point Engine::next_wakeup() {
+  auto next = Clock::time_point::max();
+  if (!delayed.empty()) {
+    next = delayed.begin()->first;
+  }
+  std::lock_guard lock(mutex);
+  if (!timers.empty()) {
+    next = std::min(next, timers.begin()->first);
+  }
+  return next;
+}
+
+void Engine::complete(std::unique_ptr<Transfer> transfer, CURLcode result) {
+  try {
+    transfer->on_complete(*transfer, result);
+  } catch (...) {
+  }
+
+  auto delay = std::exchange(transfer->resubmit_after, std::nullopt);
+  if (delay && !halted) {
+    delayed.emplace(Clock::now() + *delay, std::move(transfer));
+  }
+}
+
+void Engine::notify() {
+  if (!loop) {
+    curl_multi_wakeup(multi);
+    return;
+  }
+
+  {
+    std::lock_guard lock(mutex);
+    if (std::exchange(notified, true)) {
+      return;
+    }
+  }
+  loop->post([self = weak_self] {
+    if (auto engine = self.lock()) {
+      (*engine)->advance();
+    }
+  });
+}
+
+int Engine::on_socket(CURL *, curl_socket_t fd, int what, Engine *engine,
+                      void *) {
+  if (what == CURL_POLL_REMOVE) {
+    engine->loop->unwatch(fd);
+    engine->watched.erase(fd);
+    return 0;
+  }
+
+  auto interest = what == CURL_POLL_IN    ? Interest::Read
+                  : what == CURL_POLL_OUT ? Interest::Write
+                                          : Interest::ReadWrite;
+  engine->watched.insert(fd);
+  engine->loop->watch(
+      fd, interest, [self = engine->weak_self, fd](Interest ready) {
+        auto engine = self.lock();
+        if (!engine) {
+          return;
+        }
+        int events = 0;
+        if (static_cast<int>(ready) & static_cast<int>(Interest::Read)) {
+          events |= CURL_CSELECT_IN;
+        }
+        if (static_cast<int>(ready) & static_cast<int>(Interest::Write)) {
+          events |= CURL_CSELECT_OUT;
+        }
+        (*engine)->socket_action(fd, events);
+      });
+  return 0;
+}
+
+int Engine::on_timer(CURLM *, long timeout_ms, Engine *engine) {
+  if (timeout_ms < 0) {
+    engine->curl_deadline.reset();
+  } else {
+    engine->curl_deadline =
+        Clock::now() + std::chrono::milliseconds(timeout_ms);
+  }
+  return 0;
+}
+
+void Engine::socket_action(curl_socket_t fd, int events) {
+  int running = 0;
+  curl_multi_socket_action(multi, fd, events, &running);
+  collect();
+  advance();
+}
+
+void Engine::on_timeout() {
+  timer.reset();
+  if (curl_deadline && *curl_deadline <= Clock::now()) {
+    curl_deadline.reset();
+    socket_action(CURL_SOCKET_TIMEOUT, 0);
+  } else {
+    advance();
+  }
+}
+
+void Engine::advance() {
+  dispatch();
+
+  // One loop timer covers curl's timeout and the engine's own.
+  auto next = next_wakeup();
+  if (curl_deadline) {
+    next = std::min(next, *curl_deadline);
+  }
+  if (timer && timer->first == next) {
+    return;
+  }
+  if (timer) {
+    loop->cancel_timer(timer->second);
+    timer.reset();
+  }
+  if (next == Clock::time_point::max()) {
+    return;
+  }
+
+  auto wait = std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now());
+  auto id = loop->add_timer(std::max(wait, std::chrono::milliseconds(0)),
+                            [self = weak_self] {
+                              if (auto engine = self.lock()) {
+                                (*engine)->on_timeout();
+                              }
+                            });
+  timer.emplace(next, id);
+}
+
+} // namespace openrouter
@@ -0,0 +1,118 @@
+#pragma once
+#include "handle_pool.hpp"
+#include "openrouter/connection.hpp"
+#include "openrouter/event_loop.hpp"
+#include "request_body.hpp"
+#include <chrono>
+#include <curl/curl.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace openrouter {
+
+// Drives many transfers at once from a single thread on top of curl_multi:
+// a thread of its own, or that of a caller's EventLoop, which is then told
+// which sockets and timeouts to wait for.
+class Engine {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Transfer {
+    HandlePool::Lease handle;
+    RequestBody request_body;
+    // Runs on the engine thread once the transfer is done; exceptions are
+    // swallowed, so callers must report failures through their own channel.
+    std::function<void(Transfer &, CURLcode)> on_complete;
+    // Set by on_complete to run the same transfer again after a delay
+    // instead of releasing it.
+    std::optional<Clock::duration> resubmit_after;
+  };
+
+  // With `loop`, it must outlive the engine, which must be destroyed on the
+  // loop thread.
+  explicit Engine(const ConnectionPolicy &policy, EventLoop *loop = nullptr);
+  ~Engine();
+
+  Engine(const Engine &) = delete;
+  Engine &operator=(const Engine &) = delete;
+
+  // Runs on the engine thread; `aborted` is set instead when the engine
+  // stops first, and the task must then not start transfers.
+  using Task = std::move_only_function<void(bool aborted)>;
+
+  // Starts `transfer` after `delay`. Until then it waits with the delayed
+  // retries, and is aborted with them if the engine stops.
+  void submit(std::unique_ptr<Transfer> transfer,
+              Clock::duration delay = Clock::duration::zero());
+  // Runs `task` on the engine thread after `delay`. Scheduling on a stopped
+  // engine aborts the task at once, on the calling thread.
+  void schedule(Clock::duration delay, Task task);
+
+  // Engine thread only, i.e. from on_complete or a scheduled task.
+  void start(std::unique_ptr<Transfer> transfer);
+  // Stops a transfer, whether in flight or still waiting to start; its
+  // on_complete sees CURLE_ABORTED_BY_CALLBACK. Unknown handles are ignored.
+  void cancel(CURL *handle);
+
+private:
+  // Transfers and when to start them.
+  using Queue = std::vector<std::pair<Clock::time_point,
+                                      std::unique_ptr<Transfer>>>;
+
+  void run();
+  // Starts incoming and delayed transfers and runs due tasks. Returns false
+  // once the engine is stopping.
+  bool dispatch();
+  // Completes finished transfers.
+  void collect();
+  // Completes every transfer, started or not, as aborted.
+  void halt(Queue incoming);
+  // When the next delayed transfer or task is due.
+  Clock::time_point next_wakeup();
+  void complete(std::unique_ptr<Transfer> transfer, CURLcode result);
+  // Wakes whichever thread drives the engine. Any thread.
+  void notify();
+
+  // Caller's loop only.
+  static int on_socket(CURL *handle, curl_socket_t fd, int what,
+                       Engine *engine, void *);
+  static int on_timer(CURLM *multi, long timeout_ms, Engine *engine);
+  void socket_action(curl_socket_t fd, int events);
+  void on_timeout();
+  // Dispatches, then arms the loop timer for whichever of curl's timeout
+  // and the engine's own comes first.
+  void advance();
+
+  CURLM *multi = nullptr;
+  bool multiplex = false;
+  std::mutex mutex;
+  Queue pending;
+  std::multimap<Clock::time_point, Task> timers;
+  bool stopping = false;
+  // A wakeup is already posted to the caller's loop.
+  bool notified = false;
+
+  // Only touched on the engine thread.
+  std::unordered_map<CURL *, std::unique_ptr<Transfer>> active;
+  std::multimap<Clock::time_point, std::unique_ptr<Transfer>> delayed;
+  bool halted = false;
+  std::thread thread;
+
+  EventLoop *loop = nullptr;
+  // Expires with the engine, for loop callbacks that outlive it.
+  std::shared_ptr<Engine *> self;
+  std::weak_ptr<Engine *> weak_self;
+  std::unordered_set<curl_socket_t> watched;
+  std::optional<Clock::time_point> curl_deadline;
+  std::optional<std::pair<Clock::time_point, EventLoop::TimerId>> timer;
+};
+
+} // namespace openrouter
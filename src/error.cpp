@@ -0,0 +1,12 @@
+#include "openrouter/error.hpp"
+#include <format>
+
+namespace openrouter {
+
+HttpError::HttpError(long status, const std::string &message,
+                     std::optional<std::chrono::seconds> retry_after)
+    : std::runtime_error(
+          std::format("OpenRouter API error ({}): {}", status, message)),
+      http_status(status), retry_hint(retry_after) {}
+
+} // namespace openrouter
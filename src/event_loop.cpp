@@ -0,0 +1,179 @@
+#include "openrouter/event_loop.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <poll.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace openrouter {
+
+PollLoop::PollLoop() {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    throw std::runtime_error(
+        std::format("Failed to create pipe: {}", std::strerror(errno)));
+  }
+  wake_read = fds[0];
+  wake_write = fds[1];
+  for (int fd : fds) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+  }
+}
+
+PollLoop::~PollLoop() {
+  close(wake_read);
+  close(wake_write);
+}
+
+void PollLoop::run() {
+  while (true) {
+    std::vector<Callback> due;
+    {
+      std::lock_guard lock(mutex);
+      if (stopping) {
+        stopping = false;
+        return;
+      }
+      due.swap(posted);
+    }
+
+    for (auto &callback : due) {
+      callback();
+    }
+    fire_timers();
+
+    {
+      std::lock_guard lock(mutex);
+      if (stopping || !posted.empty()) {
+        continue;
+      }
+    }
+
+    auto deadline = Clock::time_point::max();
+    if (!deadlines.empty()) {
+      deadline = deadlines.begin()->first;
+    }
+    wait(deadline);
+  }
+}
+
+void PollLoop::stop() {
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  char byte = 0;
+  [[maybe_unused]] auto written = write(wake_write, &byte, 1);
+}
+
+void PollLoop::wait(Clock::time_point deadline) {
+  std::vector<pollfd> fds;
+  fds.reserve(watches.size() + 1);
+  fds.push_back({wake_read, POLLIN, 0});
+  for (const auto &[fd, watch] : watches) {
+    short events = 0;
+    if (static_cast<int>(watch.interest) & static_cast<int>(Interest::Read)) {
+      events |= POLLIN;
+    }
+    if (static_cast<int>(watch.interest) & static_cast<int>(Interest::Write)) {
+      events |= POLLOUT;
+    }
+    fds.push_back({fd, events, 0});
+  }
+
+  int timeout_ms = -1;
+  if (deadline != Clock::time_point::max()) {
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(deadline -
+                                                             Clock::now());
+    timeout_ms = static_cast<int>(
+        std::max<std::chrono::milliseconds::rep>(wait.count(), 0));
+  }
+
+  if (poll(fds.data(), fds.size(), timeout_ms) <= 0) {
+    return;
+  }
+
+  if (fds[0].revents) {
+    char buffer[64];
+    while (read(wake_read, buffer, sizeof(buffer)) > 0) {
+    }
+  }
+
+  for (std::size_t i = 1; i < fds.size(); ++i) {
+    short revents = fds[i].revents;
+    if (!revents) {
+      continue;
+    }
+
+    // A handler may have dropped or replaced this watch already.
+    auto it = watches.find(fds[i].fd);
+    if (it == watches.end()) {
+      continue;
+    }
+
+    int ready = 0;
+    if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+      ready = static_cast<int>(Interest::ReadWrite);
+    } else {
+      if (revents & POLLIN) {
+        ready |= static_cast<int>(Interest::Read);
+      }
+      if (revents & POLLOUT) {
+        ready |= static_cast<int>(Interest::Write);
+      }
+    }
+
+    auto on_ready = it->second.on_ready;
+    (*on_ready)(static_cast<Interest>(ready));
+  }
+}
+
+void PollLoop::fire_timers() {
+  auto now = Clock::now();
+  while (!deadlines.empty() && deadlines.begin()->first <= now) {
+    auto id = deadlines.begin()->second;
+    deadlines.erase(deadlines.begin());
+    auto node = timers.extract(id);
+    node.mapped().callback();
+  }
+}
+
+void PollLoop::watch(int fd, Interest interest, Handler on_ready) {
+  watches[fd] = {interest,
+                 std::make_shared<Handler>(std::move(on_ready))};
+}
+
+void PollLoop::unwatch(int fd) { watches.erase(fd); }
+
+EventLoop::TimerId PollLoop::add_timer(std::chrono::milliseconds delay,
+                                       Callback callback) {
+  auto id = ++next_timer;
+  auto due = Clock::now() + delay;
+  timers.emplace(id, Timer{due, std::move(callback)});
+  deadlines.emplace(due, id);
+  return id;
+}
+
+void PollLoop::cancel_timer(TimerId id) {
+  auto it = timers.find(id);
+  if (it == timers.end()) {
+    return;
+  }
+  deadlines.erase({it->second.due, id});
+  timers.erase(it);
+}
+
+void PollLoop::post(Callback callback) {
+  {
+    std::lock_guard lock(mutex);
+    posted.push_back(std::move(callback));
+  }
+  char byte = 0;
+  [[maybe_unused]] auto written = write(wake_write, &byte, 1);
+}
+
+} // namespace openrouter
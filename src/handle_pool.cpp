@@ -0,0 +1,160 @@
+#include "handle_pool.hpp"
+#include <stdexcept>
+#include <utility>
+
+namespace openrouter {
+
+HandlePool::Lease::Lease(HandlePool *pool, CURL *handle)
+    : pool(pool), handle(handle) {}
+
+HandlePool::Lease::Lease(Lease &&other) noexcept
+    : pool(std::exchange(other.pool, nullptr)),
+      handle(std::exchange(other.handle, nullptr)) {}
+
+HandlePool::Lease &HandlePool::Lease::operator=(Lease &&other) noexcept {
+  if (this != &other) {
+    if (handle) {
+      pool->release(handle);
+    }
+    pool = std::exchange(other.pool, nullptr);
+    handle = std::exchange(other.handle, nullptr);
+  }
+  return *this;
+}
+
+HandlePool::Lease::~Lease() {
+  if (handle) {
+    pool->release(handle);
+  }
+}
+
+static long curl_http_version(HttpVersion version) {
+  switch (version) {
+  case HttpVersion::Http1:
+    return CURL_HTTP_VERSION_1_1;
+  case HttpVersion::Http2:
+    return CURL_HTTP_VERSION_2TLS;
+  case HttpVersion::Http2PriorKnowledge:
+    return CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+  }
+  return CURL_HTTP_VERSION_NONE;
+}
+
+HandlePool::HandlePool(const curl_slist *headers,
+                       const ConnectionPolicy &policy, bool decode_responses)
+    : headers(headers), policy(policy),
+      http_version(curl_http_version(policy.http_version)),
+      decode_responses(decode_responses) {
+  share = curl_share_init();
+  if (!share) {
+    throw std::runtime_error("Failed to initialize curl share handle");
+  }
+
+  curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lock);
+  curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlock);
+  curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+  curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+}
+
+HandlePool::~HandlePool() {
+  for (CURL *handle : idle) {
+    curl_easy_cleanup(handle);
+  }
+  curl_share_cleanup(share);
+}
+
+HandlePool::Lease HandlePool::acquire() {
+  CURL *handle = nullptr;
+  {
+    std::lock_guard guard(mutex);
+    if (!idle.empty()) {
+      handle = idle.back();
+      idle.pop_back();
+    }
+  }
+
+  if (!handle) {
+    handle = curl_easy_init();
+    if (!handle) {
+      throw std::runtime_error("Failed to initialize curl handle");
+    }
+    configure(handle);
+  }
+
+  return Lease(this, handle);
+}
+
+void HandlePool::configure(CURL *handle) {
+  curl_easy_setopt(handle, CURLOPT_SHARE, share);
+  curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
+  curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, http_version);
+  curl_easy_setopt(handle, CURLOPT_MAXCONNECTS, policy.max_idle_connections);
+  curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN,
+                   static_cast<long>(policy.max_idle_age.count()));
+  if (policy.keepalive_idle.count() > 0) {
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE,
+                     static_cast<long>(policy.keepalive_idle.count()));
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL,
+                     static_cast<long>(policy.keepalive_interval.count()));
+  }
+  if (decode_responses) {
+    // An empty list offers every encoding this build of curl can decode.
+    curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+  }
+}
+
+void HandlePool::release(CURL *handle) {
+  record(handle);
+  // Drop per-request options, and the transfer info record() read, so the
+  // next user starts from a clean slate.
+  curl_easy_reset(handle);
+  configure(handle);
+
+  std::lock_guard guard(mutex);
+  idle.push_back(handle);
+}
+
+void HandlePool::record(CURL *handle) {
+  curl_off_t pre_transfer = 0;
+  curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME_T, &pre_transfer);
+  if (pre_transfer <= 0) {
+    return;
+  }
+
+  long connects = 0;
+  long version = 0;
+  curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+  curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &version);
+
+  transfers.fetch_add(1, std::memory_order_relaxed);
+  if (connects > 0) {
+    new_connections.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (version == CURL_HTTP_VERSION_2_0) {
+    http2_transfers.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+ConnectionStats HandlePool::stats() const {
+  ConnectionStats stats;
+  stats.transfers = transfers.load(std::memory_order_relaxed);
+  stats.new_connections = new_connections.load(std::memory_order_relaxed);
+  stats.reused = stats.transfers - stats.new_connections;
+  stats.http2 = http2_transfers.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void HandlePool::lock(CURL *, curl_lock_data data, curl_lock_access,
+                      void *userptr) {
+  static_cast<HandlePool *>(userptr)->share_locks[data].lock();
+}
+
+void HandlePool::unlock(CURL *, curl_lock_data data, void *userptr) {
+  static_cast<HandlePool *>(userptr)->share_locks[data].unlock();
+}
+
+} // namespace openrouter
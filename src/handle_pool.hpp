@@ -0,0 +1,64 @@
+#pragma once
+#include "openrouter/connection.hpp"
+#include <array>
+#include <atomic>
+#include <curl/curl.h>
+#include <mutex>
+#include <vector>
+
+namespace openrouter {
+
+// Hands out easy handles that share DNS, TLS session and connection caches,
+// and counts how the transfers they performed used connections. Safe to use
+// from any number of threads.
+class HandlePool {
+public:
+  class Lease {
+  public:
+    Lease() = default;
+    Lease(HandlePool *pool, CURL *handle);
+    Lease(Lease &&other) noexcept;
+    Lease &operator=(Lease &&other) noexcept;
+    ~Lease();
+
+    CURL *get() const { return handle; }
+
+  private:
+    HandlePool *pool = nullptr;
+    CURL *handle = nullptr;
+  };
+
+  HandlePool(const curl_slist *headers, const ConnectionPolicy &policy,
+             bool decode_responses);
+  ~HandlePool();
+
+  HandlePool(const HandlePool &) = delete;
+  HandlePool &operator=(const HandlePool &) = delete;
+
+  Lease acquire();
+  ConnectionStats stats() const;
+
+private:
+  static void lock(CURL *handle, curl_lock_data data, curl_lock_access access,
+                   void *userptr);
+  static void unlock(CURL *handle, curl_lock_data data, void *userptr);
+
+  void configure(CURL *handle);
+  void release(CURL *handle);
+  void record(CURL *handle);
+
+  const curl_slist *headers;
+  ConnectionPolicy policy;
+  long http_version;
+  bool decode_responses;
+  CURLSH *share = nullptr;
+  std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks;
+  std::mutex mutex;
+  std::vector<CURL *> idle;
+
+  std::atomic<std::uint64_t> transfers = 0;
+  std::atomic<std::uint64_t> new_connections = 0;
+  std::atomic<std::uint64_t> http2_transfers = 0;
+};
+
+} // namespace openrouter
@@ -0,0 +1,62 @@
+#include "hedger.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace openrouter {
+
+// The percentile is recomputed after this many new samples rather than on
+// every call.
+static constexpr std::size_t refresh_interval = 32;
+
+// Unused hedge budget that may pile up during quiet periods.
+static constexpr double max_tokens = 10;
+
+Hedger::Hedger(const HedgePolicy &policy) : policy(policy) {
+  samples.reserve(policy.window);
+}
+
+void Hedger::record(Duration latency) {
+  if (!policy.enabled || policy.window == 0) {
+    return;
+  }
+
+  std::lock_guard lock(mutex);
+  if (samples.size() < policy.window) {
+    samples.push_back(latency);
+  } else {
+    samples[next] = latency;
+    next = (next + 1) % policy.window;
+  }
+
+  if (++stale >= refresh_interval && samples.size() >= policy.min_samples) {
+    std::vector<Duration> sorted = samples;
+    auto rank = static_cast<std::size_t>(
+        std::ceil(policy.percentile * sorted.size()));
+    auto nth =
+        sorted.begin() + std::clamp<std::size_t>(rank, 1, sorted.size()) - 1;
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    threshold = *nth;
+    stale = 0;
+  }
+}
+
+std::optional<Hedger::Duration> Hedger::start_call() {
+  if (!policy.enabled) {
+    return std::nullopt;
+  }
+
+  std::lock_guard lock(mutex);
+  tokens = std::min(max_tokens, tokens + policy.max_fraction);
+  return threshold;
+}
+
+bool Hedger::try_hedge() {
+  std::lock_guard lock(mutex);
+  if (tokens < 1) {
+    return false;
+  }
+  tokens -= 1;
+  return true;
+}
+
+} // namespace openrouter
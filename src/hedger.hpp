@@ -0,0 +1,38 @@
+#pragma once
+#include "openrouter/hedge.hpp"
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace openrouter {
+
+// Keeps the client's recent call latencies and decides when a call has run
+// long enough to hedge. Thread-safe.
+class Hedger {
+public:
+  using Duration = std::chrono::steady_clock::duration;
+
+  explicit Hedger(const HedgePolicy &policy);
+
+  bool enabled() const { return policy.enabled; }
+
+  void record(Duration latency);
+
+  // How long a new call may run before it is hedged; nullopt while the
+  // history is too short. Counts the call towards the hedge budget.
+  std::optional<Duration> start_call();
+  // Spends hedge budget; false once hedges would exceed their share.
+  bool try_hedge();
+
+private:
+  HedgePolicy policy;
+  std::mutex mutex;
+  std::vector<Duration> samples;
+  std::size_t next = 0;
+  std::size_t stale = 0;
+  std::optional<Duration> threshold;
+  double tokens = 0;
+};
+
+} // namespace openrouter
@@ -0,0 +1,503 @@
+#pragma once
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openrouter {
+
+// Resumable JSON parser that accepts input in arbitrary chunks and reports
+// events to a handler with nlohmann's SAX signatures. Tokens split across
+// chunk boundaries are carried over, so the whole document never needs to
+// be held in memory.
+template <typename Handler> class JsonPushParser {
+public:
+  explicit JsonPushParser(Handler &handler) : handler(handler) {}
+
+  void feed(std::string_view chunk);
+  void finish();
+
+private:
+  enum class Expect {
+    Value,
+    ValueOrEnd,
+    KeyOrEnd,
+    Key,
+    Colon,
+    CommaOrEnd,
+    Done,
+  };
+
+  enum class Token {
+    None,
+    String,
+    Number,
+    Literal,
+  };
+
+  size_t scan_string(std::string_view chunk, size_t i);
+  size_t scan_escape(std::string_view chunk, size_t i);
+  size_t scan_number(std::string_view chunk, size_t i);
+  size_t scan_literal(std::string_view chunk, size_t i);
+
+  void begin_value(char c);
+  void end_string();
+  void end_number();
+  void end_literal();
+  void after_value();
+  void append_code_point(uint32_t code_point);
+  void check(bool ok);
+  [[noreturn]] void fail(std::string_view what);
+
+  Handler &handler;
+  std::vector<char> containers;
+  Expect expect = Expect::Value;
+  Token token = Token::None;
+  bool token_is_key = false;
+  std::string buffer;
+  int escape_digits = -1;
+  bool in_escape = false;
+  uint32_t code_unit = 0;
+  uint32_t high_surrogate = 0;
+  size_t offset = 0;
+};
+
+template <typename Handler>
+void JsonPushParser<Handler>::feed(std::string_view chunk) {
+  size_t i = 0;
+  while (i < chunk.size()) {
+    switch (token) {
+    case Token::String:
+      i = scan_string(chunk, i);
+      continue;
+    case Token::Number:
+      i = scan_number(chunk, i);
+      continue;
+    case Token::Literal:
+      i = scan_literal(chunk, i);
+      continue;
+    case Token::None:
+      break;
+    }
+
+    char c = chunk[i];
+    if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+      ++i;
+      continue;
+    }
+
+    switch (expect) {
+    case Expect::Value:
+    case Expect::ValueOrEnd:
+      if (expect == Expect::ValueOrEnd && c == ']') {
+        containers.pop_back();
+        check(handler.end_array());
+        after_value();
+      } else {
+        begin_value(c);
+      }
+      break;
+    case Expect::KeyOrEnd:
+    case Expect::Key:
+      if (expect == Expect::KeyOrEnd && c == '}') {
+        containers.pop_back();
+        check(handler.end_object());
+        after_value();
+      } else if (c == '"') {
+        token = Token::String;
+        token_is_key = true;
+      } else {
+        fail("expected object key");
+      }
+      break;
+    case Expect::Colon:
+      if (c != ':') {
+        fail("expected ':'");
+      }
+      expect = Expect::Value;
+      break;
+    case Expect::CommaOrEnd:
+      if (c == ',') {
+        expect = containers.back() == '{' ? Expect::Key : Expect::Value;
+      } else if (c == '}' && containers.back() == '{') {
+        containers.pop_back();
+        check(handler.end_object());
+        after_value();
+      } else if (c == ']' && containers.back() == '[') {
+        containers.pop_back();
+        check(handler.end_array());
+        after_value();
+      } else {
+        fail("expected ',' or end of container");
+      }
+      break;
+    case Expect::Done:
+      fail("unexpected data after document");
+    }
+    ++i;
+  }
+  offset += chunk.size();
+}
+
+template <typename Handler> void JsonPushParser<Handler>::finish() {
+  if (token == Token::Number) {
+    end_number();
+  } else if (token == Token::Literal) {
+    end_literal();
+  }
+
+  if (token != Token::None || expect != Expect::Done) {
+    fail("unexpected end of input");
+  }
+}
+
+template <typename Handler>
+void JsonPushParser<Handler>::begin_value(char c) {
+  switch (c) {
+  case '{':
+    containers.push_back('{');
+    check(handler.start_object(static_cast<std::size_t>(-1)));
+    expect = Expect::KeyOrEnd;
+    break;
+  case '[':
+    containers.push_back('[');
+    check(handler.start_array(static_cast<std::size_t>(-1)));
+    expect = Expect::ValueOrEnd;
+    break;
+  case '"':
+    token = Token::String;
+    token_is_key = false;
+    break;
+  case '-':
+  case '0':
+  case '1':
+  case '2':
+  case '3':
+  case '4':
+  case '5':
+  case '6':
+  case '7':
+  case '8':
+  case '9':
+    token = Token::Number;
+    buffer.push_back(c);
+    break;
+  case 't':
+  case 'f':
+  case 'n':
+    token = Token::Literal;
+    buffer.push_back(c);
+    break;
+  default:
+    fail("unexpected character");
+  }
+}
+
+template <typename Handler>
+size_t JsonPushParser<Handler>::scan_string(std::string_view chunk, size_t i) {
+  if (in_escape) {
+    return scan_escape(chunk, i);
+  }
+  // A high surrogate must be followed directly by its low half.
+  if (high_surrogate && chunk[i] != '\\') {
+    fail("unpaired surrogate");
+  }
+
+  size_t run = i;
+  for (; i < chunk.size(); ++i) {
+    auto c = static_cast<unsigned char>(chunk[i]);
+    if (c == '"') {
+      buffer.append(chunk.data() + run, i - run);
+      end_string();
+      return i + 1;
+    } else if (c == '\\') {
+      buffer.append(chunk.data() + run, i - run);
+      in_escape = true;
+      return scan_escape(chunk, i + 1);
+    } else if (c < 0x20) {
+      fail("control character in string");
+    }
+  }
+
+  buffer.append(chunk.data() + run, i - run);
+  return i;
+}
+
+template <typename Handler>
+size_t JsonPushParser<Handler>::scan_escape(std::string_view chunk, size_t i) {
+  if (escape_digits < 0) {
+    if (i >= chunk.size()) {
+      return i;
+    }
+
+    char c = chunk[i++];
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+      buffer.push_back(c);
+      break;
+    case 'b':
+      buffer.push_back('\b');
+      break;
+    case 'f':
+      buffer.push_back('\f');
+      break;
+    case 'n':
+      buffer.push_back('\n');
+      break;
+    case 'r':
+      buffer.push_back('\r');
+      break;
+    case 't':
+      buffer.push_back('\t');
+      break;
+    case 'u':
+      escape_digits = 0;
+      code_unit = 0;
+      break;
+    default:
+      fail("invalid escape sequence");
+    }
+
+    if (escape_digits < 0) {
+      if (high_surrogate) {
+        fail("unpaired surrogate");
+      }
+      in_escape = false;
+      return i;
+    }
+  }
+
+  while (escape_digits < 4 && i < chunk.size()) {
+    char c = chunk[i++];
+    code_unit <<= 4;
+    if (c >= '0' && c <= '9') {
+      code_unit |= c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      code_unit |= c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      code_unit |= c - 'A' + 10;
+    } else {
+      fail("invalid unicode escape");
+    }
+    ++escape_digits;
+  }
+
+  if (escape_digits < 4) {
+    return i;
+  }
+
+  escape_digits = -1;
+  in_escape = false;
+
+  if (high_surrogate) {
+    if (code_unit < 0xDC00 || code_unit > 0xDFFF) {
+      fail("unpaired surrogate");
+    }
+    append_code_point(0x10000 + ((high_surrogate - 0xD800) << 10) +
+                      (code_unit - 0xDC00));
+    high_surrogate = 0;
+  } else if (code_unit >= 0xD800 && code_unit <= 0xDBFF) {
+    high_surrogate = code_unit;
+  } else if (code_unit >= 0xDC00 && code_unit <= 0xDFFF) {
+    fail("unpaired surrogate");
+  } else {
+    append_code_point(code_unit);
+  }
+
+  return i;
+}
+
+template <typename Handler>
+size_t JsonPushParser<Handler>::scan_number(std::string_view chunk, size_t i) {
+  for (; i < chunk.size(); ++i) {
+    char c = chunk[i];
+    if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' ||
+        c == '+' || c == '-') {
+      buffer.push_back(c);
+    } else {
+      end_number();
+      return i;
+    }
+  }
+  return i;
+}
+
+template <typename Handler>
+size_t JsonPushParser<Handler>::scan_literal(std::string_view chunk, size_t i) {
+  for (; i < chunk.size(); ++i) {
+    char c = chunk[i];
+    if (c >= 'a' && c <= 'z') {
+      buffer.push_back(c);
+    } else {
+      end_literal();
+      return i;
+    }
+  }
+  return i;
+}
+
+template <typename Handler> void JsonPushParser<Handler>::end_string() {
+  if (high_surrogate) {
+    fail("unpaired surrogate");
+  }
+
+  token = Token::None;
+  if (token_is_key) {
+    check(handler.key(buffer));
+    buffer.clear();
+    expect = Expect::Colon;
+  } else {
+    check(handler.string(buffer));
+    buffer.clear();
+    after_value();
+  }
+}
+
+// The JSON number grammar, which from_chars is laxer than: no leading
+// zeros, and digits on both sides of the point and after the exponent.
+inline bool valid_json_number(std::string_view number) {
+  size_t i = 0;
+  auto digits = [&] {
+    size_t start = i;
+    while (i < number.size() && number[i] >= '0' && number[i] <= '9') {
+      ++i;
+    }
+    return i > start;
+  };
+
+  if (i < number.size() && number[i] == '-') {
+    ++i;
+  }
+  if (i < number.size() && number[i] == '0') {
+    ++i;
+  } else if (!digits()) {
+    return false;
+  }
+  if (i < number.size() && number[i] == '.') {
+    ++i;
+    if (!digits()) {
+      return false;
+    }
+  }
+  if (i < number.size() && (number[i] == 'e' || number[i] == 'E')) {
+    ++i;
+    if (i < number.size() && (number[i] == '+' || number[i] == '-')) {
+      ++i;
+    }
+    if (!digits()) {
+      return false;
+    }
+  }
+  return i == number.size();
+}
+
+template <typename Handler> void JsonPushParser<Handler>::end_number() {
+  token = Token::None;
+  if (!valid_json_number(buffer)) {
+    fail("invalid number");
+  }
+
+  const char *first = buffer.data();
+  const char *last = buffer.data() + buffer.size();
+  bool is_float = buffer.find_first_of(".eE") != std::string::npos;
+
+  if (!is_float) {
+    if (buffer.front() == '-') {
+      int64_t value;
+      auto [ptr, ec] = std::from_chars(first, last, value);
+      if (ec == std::errc() && ptr == last) {
+        check(handler.number_integer(value));
+        buffer.clear();
+        after_value();
+        return;
+      }
+    } else {
+      uint64_t value;
+      auto [ptr, ec] = std::from_chars(first, last, value);
+      if (ec == std::errc() && ptr == last) {
+        check(handler.number_unsigned(value));
+        buffer.clear();
+        after_value();
+        return;
+      }
+    }
+  }
+
+  double value;
+  auto [ptr, ec] = std::from_chars(first, last, value);
+  if (ec == std::errc::result_out_of_range) {
+    // from_chars leaves `value` alone; underflow rounds towards zero, while
+    // overflow is an error as it is for nlohmann.
+    value = std::strtod(buffer.c_str(), nullptr);
+    if (!std::isfinite(value)) {
+      fail("number overflow");
+    }
+  } else if (ec != std::errc() || ptr != last) {
+    fail("invalid number");
+  }
+  check(handler.number_float(value, buffer));
+  buffer.clear();
+  after_value();
+}
+
+template <typename Handler> void JsonPushParser<Handler>::end_literal() {
+  token = Token::None;
+
+  if (buffer == "true") {
+    check(handler.boolean(true));
+  } else if (buffer == "false") {
+    check(handler.boolean(false));
+  } else if (buffer == "null") {
+    check(handler.null());
+  } else {
+    fail("invalid literal");
+  }
+
+  buffer.clear();
+  after_value();
+}
+
+template <typename Handler> void JsonPushParser<Handler>::after_value() {
+  expect = containers.empty() ? Expect::Done : Expect::CommaOrEnd;
+}
+
+template <typename Handler>
+void JsonPushParser<Handler>::append_code_point(uint32_t code_point) {
+  if (code_point < 0x80) {
+    buffer.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    buffer.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    buffer.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    buffer.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    buffer.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    buffer.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    buffer.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    buffer.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    buffer.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    buffer.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+template <typename Handler> void JsonPushParser<Handler>::check(bool ok) {
+  if (!ok) {
+    fail("parsing aborted by handler");
+  }
+}
+
+template <typename Handler>
+void JsonPushParser<Handler>::fail(std::string_view what) {
+  throw std::runtime_error(
+      std::format("JSON parse error near byte {}: {}", offset, what));
+}
+
+} // namespace openrouter
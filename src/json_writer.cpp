@@ -0,0 +1,199 @@
+#include "json_writer.hpp"
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+
+namespace openrouter {
+
+void JsonWriter::separator() {
+  if (needs_comma) {
+    out->push_back(',');
+  }
+}
+
+void JsonWriter::begin_object() {
+  separator();
+  out->push_back('{');
+  needs_comma = false;
+}
+
+void JsonWriter::end_object() {
+  out->push_back('}');
+  needs_comma = true;
+}
+
+void JsonWriter::begin_array() {
+  separator();
+  out->push_back('[');
+  needs_comma = false;
+}
+
+void JsonWriter::end_array() {
+  out->push_back(']');
+  needs_comma = true;
+}
+
+void JsonWriter::key(std::string_view name) {
+  separator();
+  escape(name);
+  out->push_back(':');
+  needs_comma = false;
+}
+
+void JsonWriter::value(std::string_view text) {
+  separator();
+  escape(text);
+  needs_comma = true;
+}
+
+void JsonWriter::value(double number) {
+  separator();
+  if (!std::isfinite(number)) {
+    out->append("null");
+  } else {
+    std::array<char, 32> buffer;
+    auto [end, ec] =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+    out->append(buffer.data(), end);
+  }
+  needs_comma = true;
+}
+
+void JsonWriter::value(bool boolean) {
+  separator();
+  out->append(boolean ? "true" : "false");
+  needs_comma = true;
+}
+
+void JsonWriter::raw(std::string_view json) {
+  separator();
+  out->append(json);
+  needs_comma = true;
+}
+
+void JsonWriter::raw(const RequestBody &json) {
+  separator();
+  if (body) {
+    body->append(json);
+    out = &body->text();
+  } else {
+    json.flatten(*out);
+  }
+  needs_comma = true;
+}
+
+void JsonWriter::attachment(const Attachment &attachment, bool data_url) {
+  separator();
+  out->push_back('"');
+  if (data_url && !attachment.mime_type().empty()) {
+    out->append(std::format("data:{};base64,", attachment.mime_type()));
+  }
+
+  if (body) {
+    body->append(attachment);
+    out = &body->text();
+  } else {
+    out->append(attachment.encode(false));
+  }
+
+  out->push_back('"');
+  needs_comma = true;
+}
+
+// Length of the well-formed UTF-8 sequence at `text[i]`, or 0 if it is
+// malformed, overlong, a surrogate or beyond U+10FFFF.
+static size_t utf8_length(std::string_view text, size_t i) {
+  auto byte = [&](size_t k) -> unsigned char {
+    return i + k < text.size() ? static_cast<unsigned char>(text[i + k]) : 0;
+  };
+
+  unsigned char lead = byte(0);
+  unsigned char low = 0x80;
+  unsigned char high = 0xBF;
+  size_t length;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    low = lead == 0xE0 ? 0xA0 : low;
+    high = lead == 0xED ? 0x9F : high;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    low = lead == 0xF0 ? 0x90 : low;
+    high = lead == 0xF4 ? 0x8F : high;
+  } else {
+    return 0;
+  }
+
+  if (byte(1) < low || byte(1) > high) {
+    return 0;
+  }
+  for (size_t k = 2; k < length; ++k) {
+    if (byte(k) < 0x80 || byte(k) > 0xBF) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+void JsonWriter::escape(std::string_view text) {
+  static constexpr char hex[] = "0123456789abcdef";
+
+  out->push_back('"');
+  size_t run = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    auto c = static_cast<unsigned char>(text[i]);
+    if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+      continue;
+    }
+    // Malformed text is refused before anything is sent, as nlohmann's
+    // dump() did, rather than left for the server to reject.
+    if (c >= 0x80) {
+      size_t length = utf8_length(text, i);
+      if (!length) {
+        throw std::runtime_error(std::format(
+            "Invalid UTF-8 byte at index {}: 0x{:02X}", i, c));
+      }
+      i += length - 1;
+      continue;
+    }
+
+    out->append(text.data() + run, i - run);
+    run = i + 1;
+
+    switch (c) {
+    case '"':
+      out->append("\\\"");
+      break;
+    case '\\':
+      out->append("\\\\");
+      break;
+    case '\b':
+      out->append("\\b");
+      break;
+    case '\f':
+      out->append("\\f");
+      break;
+    case '\n':
+      out->append("\\n");
+      break;
+    case '\r':
+      out->append("\\r");
+      break;
+    case '\t':
+      out->append("\\t");
+      break;
+    default:
+      out->append("\\u00");
+      out->push_back(hex[c >> 4]);
+      out->push_back(hex[c & 0xf]);
+      break;
+    }
+  }
+  out->append(text.data() + run, text.size() - run);
+  out->push_back('"');
+}
+
+} // namespace openrouter
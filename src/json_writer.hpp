@@ -0,0 +1,70 @@
+#pragma once
+#include "openrouter/responses.hpp"
+#include "request_body.hpp"
+#include <string>
+#include <string_view>
+
+namespace openrouter {
+
+// Appends JSON text to a caller-owned buffer without building a DOM. When
+// writing into a RequestBody, attachments are left for the transfer to
+// encode instead of being inlined.
+class JsonWriter {
+public:
+  explicit JsonWriter(std::string &out) : out(&out) {}
+  explicit JsonWriter(RequestBody &body) : out(&body.text()), body(&body) {}
+
+  void begin_object();
+  void end_object();
+  void begin_array();
+  void end_array();
+
+  void key(std::string_view name);
+  void value(std::string_view text);
+  void value(const char *text) { value(std::string_view(text)); }
+  void value(double number);
+  void value(bool boolean);
+  void raw(std::string_view json);
+  // Splices pre-serialized JSON, keeping its attachments as segments when
+  // writing into a RequestBody.
+  void raw(const RequestBody &json);
+  void attachment(const Attachment &attachment, bool data_url);
+
+private:
+  void separator();
+  void escape(std::string_view text);
+
+  std::string *out;
+  RequestBody *body = nullptr;
+  bool needs_comma = false;
+};
+
+void write(JsonWriter &w, const InputText &text);
+void write(JsonWriter &w, const InputImage &image);
+void write(JsonWriter &w, const InputFile &file);
+void write(JsonWriter &w, const InputAudio &audio);
+void write(JsonWriter &w, const OpenResponsesEasyInputMessageContent &content);
+void write(JsonWriter &w, const OpenResponsesReasoning &reasoning);
+void write(JsonWriter &w, const OpenResponsesEasyInputMessage &message);
+void write(JsonWriter &w, const OpenResponsesInputMessageItem &message_item);
+void write(JsonWriter &w, const OpenResponsesFunctionToolCall &func_call);
+void write(JsonWriter &w,
+           const OpenResponsesFunctionCallOutput &func_call_output);
+void write(JsonWriter &w, const ResponseOutputText &text);
+void write(JsonWriter &w, const OpenAIResponsesRefusalContent &refusal);
+void write(JsonWriter &w, const ResponsesOutputMessage &message);
+void write(JsonWriter &w, const ResponsesOutputItemReasoning &reasoning);
+void write(JsonWriter &w,
+           const ResponsesOutputItemFunctionCall &function_call);
+void write(JsonWriter &w, const ResponsesWebSearchCallOutput &web_search_call);
+void write(JsonWriter &w,
+           const ResponsesOutputItemFileSearchCall &file_search_call);
+void write(JsonWriter &w,
+           const ResponsesImageGenerationCall &image_generation_call);
+void write(JsonWriter &w, const OpenResponsesInput &input);
+
+// `stream` overrides Request::stream when set.
+void write(JsonWriter &w, const Request &req,
+           std::optional<bool> stream = std::nullopt);
+
+} // namespace openrouter
@@ -0,0 +1,179 @@
+#include "limiter.hpp"
+#include "openrouter/error.hpp"
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace openrouter {
+
+// Congestion is judged on a short moving average of latency against a slow
+// one, so a single slow response does not shrink the window but a sudden
+// sustained rise does.
+static constexpr int recent_decay = 8;
+static constexpr int baseline_decay = 64;
+
+Limiter::Limiter(const LimiterPolicy &policy)
+    : policy(policy), window(std::clamp(policy.initial_window,
+                                        policy.min_window, policy.max_window)),
+      tokens(policy.burst), refilled(Clock::now()) {}
+
+void Limiter::acquire(Priority priority, Start start) {
+  if (!policy.enabled) {
+    try {
+      start(Clock::duration::zero());
+    } catch (...) {
+    }
+    return;
+  }
+
+  std::unique_lock lock(mutex);
+  queues[static_cast<std::size_t>(priority)].push_back(std::move(start));
+  grant(lock);
+}
+
+void Limiter::wait(Priority priority) {
+  if (!policy.enabled) {
+    return;
+  }
+
+  auto granted = std::make_shared<std::promise<Clock::duration>>();
+  auto delay = granted->get_future();
+  acquire(priority,
+          [granted](Clock::duration delay) { granted->set_value(delay); });
+  std::this_thread::sleep_for(delay.get());
+}
+
+void Limiter::release() {
+  if (!policy.enabled) {
+    return;
+  }
+
+  std::unique_lock lock(mutex);
+  --in_flight;
+  grant(lock);
+}
+
+void Limiter::on_success(Clock::duration latency, Sample sample) {
+  if (!policy.enabled) {
+    return;
+  }
+
+  std::unique_lock lock(mutex);
+  auto &[baseline, recent] = averages[static_cast<std::size_t>(sample)];
+  if (!baseline) {
+    baseline = recent = latency;
+  }
+  *recent += (latency - *recent) / recent_decay;
+
+  if (*recent > policy.latency_tolerance * *baseline) {
+    decrease(Clock::now());
+  } else if (2 * static_cast<double>(in_flight) >= window) {
+    // An idle window says nothing about capacity; only grow a busy one.
+    window = std::min(policy.max_window, window + policy.increase / window);
+  }
+  *baseline += (latency - *baseline) / baseline_decay;
+
+  grant(lock);
+}
+
+void Limiter::on_failure(std::exception_ptr error) {
+  if (!policy.enabled) {
+    return;
+  }
+
+  try {
+    std::rethrow_exception(error);
+  } catch (const HttpError &e) {
+    if (e.status() == 429 || e.status() == 503) {
+      std::lock_guard lock(mutex);
+      decrease(Clock::now());
+    }
+  } catch (...) {
+  }
+}
+
+void Limiter::close() {
+  std::unique_lock lock(mutex);
+  closed = true;
+  grant(lock);
+}
+
+LimiterStats Limiter::stats() const {
+  std::lock_guard lock(mutex);
+  LimiterStats stats;
+  stats.window = window;
+  stats.in_flight = in_flight;
+  for (std::size_t i = 0; i < queues.size(); ++i) {
+    stats.queued_by_priority[i] = queues[i].size();
+    stats.queued += queues[i].size();
+  }
+  return stats;
+}
+
+// Reserves the next token, letting the balance go negative so that queued
+// starts are spaced out at `rate` rather than released together.
+Limiter::Clock::duration Limiter::reserve_token(Clock::time_point now) {
+  if (policy.rate <= 0) {
+    return Clock::duration::zero();
+  }
+
+  std::chrono::duration<double> elapsed = now - refilled;
+  tokens = std::min(policy.burst, tokens + elapsed.count() * policy.rate);
+  refilled = now;
+  tokens -= 1;
+  if (tokens >= 0) {
+    return Clock::duration::zero();
+  }
+  return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(-tokens / policy.rate));
+}
+
+// One congestion signal per round trip: the 429s of a single burst arrive
+// together and should only shrink the window once.
+void Limiter::decrease(Clock::time_point now) {
+  // The quickest signal measured so far is the closest to a round trip.
+  std::optional<Clock::duration> rtt;
+  for (const auto &average : averages) {
+    if (average.recent) {
+      rtt = std::min(rtt.value_or(*average.recent), *average.recent);
+    }
+  }
+  if (last_decrease &&
+      now - *last_decrease < rtt.value_or(policy.initial_rtt)) {
+    return;
+  }
+  window = std::max(policy.min_window, window * policy.decrease);
+  last_decrease = now;
+}
+
+// Starts queued calls while the window has room. The callbacks run after the
+// lock is dropped since they may submit work or wake other threads. One that
+// throws gives its slot back; it must report the failure to its call.
+void Limiter::grant(std::unique_lock<std::mutex> &lock) {
+  std::vector<std::pair<Start, Clock::duration>> ready;
+  auto now = Clock::now();
+  while (closed || static_cast<double>(in_flight) + 1 <= window) {
+    auto queue = std::ranges::find_if(
+        queues, [](const auto &queue) { return !queue.empty(); });
+    if (queue == queues.end()) {
+      break;
+    }
+    ready.emplace_back(std::move(queue->front()), reserve_token(now));
+    queue->pop_front();
+    ++in_flight;
+  }
+  lock.unlock();
+
+  for (auto &[start, delay] : ready) {
+    try {
+      start(delay);
+    } catch (...) {
+      release();
+    }
+  }
+}
+
+} // namespace openrouter
@@ -0,0 +1,70 @@
+#pragma once
+#include "openrouter/limiter.hpp"
+#include <array>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+namespace openrouter {
+
+// The AIMD window, token bucket and priority queue behind LimiterPolicy.
+// Thread-safe.
+class Limiter {
+public:
+  using Clock = std::chrono::steady_clock;
+  // Receives how long the call must still wait for the token bucket.
+  using Start = std::move_only_function<void(Clock::duration)>;
+
+  explicit Limiter(const LimiterPolicy &policy);
+
+  bool enabled() const { return policy.enabled; }
+
+  // Runs `start` once the call has a slot: inline when one is free,
+  // otherwise on the thread whose release() frees one. If `start` throws,
+  // the slot is released and the exception swallowed.
+  void acquire(Priority priority, Start start);
+  // Blocking form of acquire() that also waits out the token bucket.
+  void wait(Priority priority);
+  void release();
+
+  // What a latency sample measures. Each kind is compared only with its own
+  // averages: a stream's first event comes long before a full response.
+  enum class Sample { Response, FirstEvent };
+
+  // Feeds one attempt's outcome into the window.
+  void on_success(Clock::duration latency, Sample sample = Sample::Response);
+  // Only 429 and 503 count as overload; other failures are ignored.
+  void on_failure(std::exception_ptr error);
+
+  // Starts every queued call so it can fail through the normal path.
+  void close();
+
+  LimiterStats stats() const;
+
+private:
+  Clock::duration reserve_token(Clock::time_point now);
+  void decrease(Clock::time_point now);
+  void grant(std::unique_lock<std::mutex> &lock);
+
+  LimiterPolicy policy;
+  mutable std::mutex mutex;
+  double window;
+  std::size_t in_flight = 0;
+  std::array<std::deque<Start>, 3> queues;
+  bool closed = false;
+
+  double tokens;
+  Clock::time_point refilled;
+
+  struct Averages {
+    std::optional<Clock::duration> baseline;
+    std::optional<Clock::duration> recent;
+  };
+  std::array<Averages, 2> averages;
+  std::optional<Clock::time_point> last_decrease;
+};
+
+} // namespace openrouter
@@ -1,59 +1,97 @@
 #include "openrouter/openrouter.hpp"
+#include "cache.hpp"
+#include "compressor.hpp"
+#include "engine.hpp"
+#include "handle_pool.hpp"
+#include "hedger.hpp"
+#include "json_push_parser.hpp"
+#include "json_writer.hpp"
+#include "limiter.hpp"
+#include "openrouter/serializer.hpp"
+#include "request_body.hpp"
+#include "response_decoder.hpp"
+#include "retrier.hpp"
+#include "sse.hpp"
+#include "tags.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdlib>
+#include <exception>
 #include <format>
+#include <latch>
+#include <memory>
 #include <nlohmann/json.hpp>
+#include <semaphore>
+#include <thread>
 
 namespace openrouter {
 
-static size_t write_callback(char *ptr, size_t size, size_t nmemb,
-                             std::string *data) {
-  data->append(ptr, size * nmemb);
-  return size * nmemb;
-}
+using Clock = std::chrono::steady_clock;
 
-std::string OpenRouter::http_get(const std::string &url) {
-  std::string response;
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-  curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+static size_t read_callback(char *buffer, size_t size, size_t nitems,
+                            RequestBody *body) {
+  return body->read(buffer, size * nitems);
+}
 
-  CURLcode res = curl_easy_perform(curl);
-  if (res != CURLE_OK) {
-    throw std::runtime_error(curl_easy_strerror(res));
+static int seek_callback(RequestBody *body, curl_off_t offset, int origin) {
+  if (origin != SEEK_SET || offset != 0) {
+    return CURL_SEEKFUNC_CANTSEEK;
   }
 
-  return response;
+  body->rewind();
+  return CURL_SEEKFUNC_OK;
 }
 
-std::string OpenRouter::http_post(const std::string &url,
-                                  const std::string &data) {
-  std::string response;
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-  curl_easy_setopt(curl, CURLOPT_POST, 1L);
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+static void configure_post(CURL *handle, const char *url,
+                           RequestBody &body, curl_write_callback write,
+                           void *userdata) {
+  curl_easy_setopt(handle, CURLOPT_URL, url);
+  curl_easy_setopt(handle, CURLOPT_POST, 1L);
+  if (body.headers()) {
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, body.headers());
+  }
 
-  CURLcode res = curl_easy_perform(curl);
-  if (res != CURLE_OK) {
-    throw std::runtime_error(curl_easy_strerror(res));
+  if (body.contiguous()) {
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDS, body.text().c_str());
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, body.text().size());
+  } else {
+    body.rewind();
+    curl_easy_setopt(handle, CURLOPT_READFUNCTION, read_callback);
+    curl_easy_setopt(handle, CURLOPT_READDATA, &body);
+    curl_easy_setopt(handle, CURLOPT_SEEKFUNCTION, seek_callback);
+    curl_easy_setopt(handle, CURLOPT_SEEKDATA, &body);
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE,
+                     static_cast<curl_off_t>(body.size()));
   }
 
-  return response;
+  curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, write);
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, userdata);
+}
+
+CURLcode OpenRouter::http_post(CURL *curl, const std::string &url,
+                               RequestBody &body, curl_write_callback write,
+                               void *userdata) {
+  configure_post(curl, url.c_str(), body, write, userdata);
+  return curl_easy_perform(curl);
 }
 
-OpenRouter::OpenRouter(std::optional<std::string_view> api_key) {
-  curl = curl_easy_init();
+OpenRouter::OpenRouter(std::optional<std::string_view> api_key,
+                       ClientOptions options)
+    : options(std::move(options)) {
+  std::string_view base_url = this->options.base_url;
+  while (base_url.ends_with('/')) {
+    base_url.remove_suffix(1);
+  }
+  responses_url = std::format("{}/responses", base_url);
 
   if (api_key) {
     headers = curl_slist_append(
         headers, std::format("Authorization: Bearer {}", *api_key).c_str());
   } else {
     auto env_key = std::getenv("OPENROUTER_API_KEY");
-    if (!api_key) {
+    if (!env_key) {
       throw std::runtime_error("API key not provided and OPENROUTER_API_KEY "
                                "environment variable not set");
     }
@@ -63,28 +101,850 @@ OpenRouter::OpenRouter(std::optional<std::string_view> api_key) {
   }
 
   headers = curl_slist_append(headers, "Content-Type: application/json");
+  // Large streamed bodies would otherwise wait on a 100-continue round trip.
+  headers = curl_slist_append(headers, "Expect:");
+
+  pool = std::make_unique<HandlePool>(
+      headers, this->options.connection,
+      this->options.compression.decode_responses);
+  retrier = std::make_unique<Retrier>(this->options.retry);
+  hedger = std::make_unique<Hedger>(this->options.hedge);
+  limiter = std::make_unique<Limiter>(this->options.limiter);
+  cache = std::make_unique<ResponseCache>(this->options.cache);
+  compressor =
+      std::make_unique<Compressor>(this->options.compression, headers);
 
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+  if (this->options.connection.prewarm > 0) {
+    // Failures surface on the first call instead.
+    warm(this->options.connection.prewarm);
+  }
 }
 
 OpenRouter::~OpenRouter() {
-  curl_easy_cleanup(curl);
+  // Queued asynchronous calls are started so the engine can abort them.
+  limiter->close();
+  engine.reset();
+  pool.reset();
   curl_slist_free_all(headers);
 }
 
+static std::string error_message(const nlohmann::json &json) {
+  const auto &error = json.contains("error") ? json["error"] : json;
+  if (error.contains("message") && error["message"].is_string()) {
+    return error["message"].get<std::string>();
+  }
+  return error.dump();
+}
+
+static long response_code(CURL *handle) {
+  long status = 0;
+  curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+  return status;
+}
+
+// Error bodies are only kept for their message; cap what a misbehaving
+// proxy can make us buffer.
+static constexpr size_t max_error_body = 64 * 1024;
+
+static void append_error_body(std::string &body, const char *data,
+                              size_t size) {
+  size_t room = max_error_body - std::min(max_error_body, body.size());
+  body.append(data, std::min(size, room));
+}
+
+static HttpError http_error(CURL *handle, long status,
+                            const std::string &body) {
+  curl_off_t retry_after = 0;
+  curl_easy_getinfo(handle, CURLINFO_RETRY_AFTER, &retry_after);
+  std::optional<std::chrono::seconds> hint;
+  if (retry_after > 0) {
+    hint = std::chrono::seconds(retry_after);
+  }
+
+  auto json = nlohmann::json::parse(body, nullptr, false);
+  if (!json.is_discarded()) {
+    return HttpError(status, error_message(json), hint);
+  }
+  return HttpError(status, body.empty() ? "empty response body" : body, hint);
+}
+
+// Feeds RequestHooks::after_attempt for one attempt.
+struct AttemptReport {
+  const RequestHooks *hooks = nullptr;
+  int attempt = 1;
+  Clock::duration serialize{};
+  Clock::duration compress{};
+  Clock::duration parse{};
+
+  void publish(CURL *handle, std::exception_ptr error) const {
+    if (!hooks || !hooks->after_attempt) {
+      return;
+    }
+
+    auto micros = [handle](CURLINFO info) {
+      curl_off_t value = 0;
+      curl_easy_getinfo(handle, info, &value);
+      return std::chrono::microseconds(value);
+    };
+    auto bytes = [handle](CURLINFO info) {
+      curl_off_t value = 0;
+      curl_easy_getinfo(handle, info, &value);
+      return static_cast<std::uint64_t>(value);
+    };
+    using std::chrono::duration_cast;
+
+    hooks->after_attempt(
+        RequestTiming{
+            .attempt = attempt,
+            .status = response_code(handle),
+            .name_lookup = micros(CURLINFO_NAMELOOKUP_TIME_T),
+            .connect = micros(CURLINFO_CONNECT_TIME_T),
+            .app_connect = micros(CURLINFO_APPCONNECT_TIME_T),
+            .pre_transfer = micros(CURLINFO_PRETRANSFER_TIME_T),
+            .start_transfer = micros(CURLINFO_STARTTRANSFER_TIME_T),
+            .total = micros(CURLINFO_TOTAL_TIME_T),
+            .bytes_sent = bytes(CURLINFO_SIZE_UPLOAD_T),
+            .bytes_received = bytes(CURLINFO_SIZE_DOWNLOAD_T),
+            .serialize = duration_cast<std::chrono::microseconds>(serialize),
+            .compress = duration_cast<std::chrono::microseconds>(compress),
+            .parse = duration_cast<std::chrono::microseconds>(parse),
+        },
+        error);
+  }
+};
+
+static Clock::duration write_body(RequestBody &body, const Request &request,
+                                  bool stream = false) {
+  auto started = Clock::now();
+  JsonWriter writer(body);
+  write(writer, request, stream);
+  return Clock::now() - started;
+}
+
+// Holds a limiter slot for the whole of a synchronous call, retries included.
+struct LimiterSlot {
+  LimiterSlot(Limiter &limiter, Priority priority) : limiter(limiter) {
+    limiter.wait(priority);
+  }
+  ~LimiterSlot() { limiter.release(); }
+
+  Limiter &limiter;
+};
+
+// Runs `attempt` until it succeeds or the retrier gives up. Once `committed`
+// is set, output has reached the caller and failures are no longer retried.
+template <typename Attempt>
+static auto with_retries(Retrier &retrier, Limiter &limiter, Attempt &&attempt,
+                         const bool &committed = false) {
+  retrier.record_request();
+  for (int n = 1;; ++n) {
+    try {
+      return attempt();
+    } catch (...) {
+      limiter.on_failure(std::current_exception());
+      if (committed) {
+        throw;
+      }
+      auto delay = retrier.next_delay(n, std::current_exception());
+      if (!delay) {
+        throw;
+      }
+      std::this_thread::sleep_for(*delay);
+    }
+  }
+}
+
+// Decodes the body chunk by chunk as curl receives it, so parsing overlaps
+// the transfer and the raw body is never buffered. Error statuses are
+// buffered instead and surface as HttpError. A successful body is also
+// copied to `captured` when it is set, for the response cache.
+template <typename Decoder> struct DecodeContext {
+  DecodeContext(typename Decoder::Response &response, CURL *handle)
+      : handle(handle), decoder(response) {}
+
+  CURL *handle;
+  Decoder decoder;
+  JsonPushParser<Decoder> parser{decoder};
+  std::string error_body;
+  std::string *captured = nullptr;
+  std::exception_ptr error;
+  AttemptReport report;
+
+  void finish(CURLcode result) {
+    try {
+      check(result);
+    } catch (...) {
+      report.publish(handle, std::current_exception());
+      throw;
+    }
+    report.publish(handle, nullptr);
+  }
+
+private:
+  void check(CURLcode result) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    if (result != CURLE_OK) {
+      throw TransportError(result);
+    }
+    if (long status = response_code(handle); status >= 400) {
+      throw http_error(handle, status, error_body);
+    }
+
+    auto started = Clock::now();
+    parser.finish();
+    report.parse += Clock::now() - started;
+    if (decoder.error()) {
+      throw std::runtime_error(
+          std::format("OpenRouter API error: {}", *decoder.error()));
+    }
+  }
+};
+
+template <typename Decoder>
+static size_t decode_write_callback(char *ptr, size_t size, size_t nmemb,
+                                    DecodeContext<Decoder> *ctx) {
+  if (response_code(ctx->handle) >= 400) {
+    append_error_body(ctx->error_body, ptr, size * nmemb);
+    return size * nmemb;
+  }
+  if (ctx->captured) {
+    ctx->captured->append(ptr, size * nmemb);
+  }
+
+  try {
+    auto started = Clock::now();
+    ctx->parser.feed(std::string_view(ptr, size * nmemb));
+    ctx->report.parse += Clock::now() - started;
+  } catch (...) {
+    ctx->error = std::current_exception();
+    return 0;
+  }
+
+  return size * nmemb;
+}
+
+template <typename Decoder>
+static void configure_decode(CURL *handle, const std::string &url,
+                             RequestBody &body, DecodeContext<Decoder> &ctx) {
+  configure_post(handle, url.c_str(), body,
+                 reinterpret_cast<curl_write_callback>(
+                     decode_write_callback<Decoder>),
+                 &ctx);
+}
+
+template <typename Decoder>
+static void perform_decode(CURL *handle, const std::string &url,
+                           RequestBody &body,
+                           typename Decoder::Response &response,
+                           std::string *captured,
+                           const AttemptReport &report) {
+  DecodeContext<Decoder> ctx(response, handle);
+  ctx.captured = captured;
+  ctx.report = report;
+  configure_decode(handle, url, body, ctx);
+  ctx.finish(curl_easy_perform(handle));
+}
+
 Response OpenRouter::create_response(const Request &request) {
-  std::string request_body = nlohmann::json(request).dump();
-  nlohmann::json json = nlohmann::json::parse(
-      http_post("https://openrouter.ai/api/v1/responses", request_body));
+  if (request.stream.value_or(false)) {
+    return create_response(request, [](const ResponseStreamEvent &) {});
+  }
+
+  if (hedger->enabled()) {
+    return create_response_async(request).get();
+  }
+
+  if (options.hooks.before_request) {
+    options.hooks.before_request(request);
+  }
+
+  RequestBody request_body;
+  AttemptReport report{&options.hooks, 0, write_body(request_body, request)};
+
+  std::optional<CacheKey> key;
+  if (cache->enabled()) {
+    key = ResponseCache::key(request_body);
+    if (auto body = cache->get(*key)) {
+      Response response;
+      deserialize(*body, response);
+      return response;
+    }
+  }
+
+  report.compress = compressor->compress(request_body);
+  LimiterSlot slot(*limiter, request.priority);
+  return with_retries(*retrier, *limiter, [&] {
+    auto lease = pool->acquire();
+    Response response;
+    std::string captured;
+    ++report.attempt;
+    auto started = Clock::now();
+    perform_decode<ResponseDecoder>(lease.get(), responses_url, request_body,
+                                    response, key ? &captured : nullptr,
+                                    report);
+    limiter->on_success(Clock::now() - started);
+    if (key) {
+      cache->put(*key, std::move(captured));
+    }
+    return response;
+  });
+}
 
-  if (!json["error"].is_null()) {
+void OpenRouter::create_response(const Request &request,
+                                 pmr::Response &response) {
+  if (request.stream.value_or(false)) {
     throw std::runtime_error(
-        std::format("OpenRouter API error: {}",
-                    json["error"]["message"].get<std::string>()));
+        "Streaming requests cannot be decoded into a pmr::Response");
+  }
+
+  if (options.hooks.before_request) {
+    options.hooks.before_request(request);
   }
 
-  return json.get<Response>();
+  RequestBody request_body;
+  AttemptReport report{&options.hooks, 0, write_body(request_body, request)};
+
+  std::optional<CacheKey> key;
+  if (cache->enabled()) {
+    key = ResponseCache::key(request_body);
+    if (auto body = cache->get(*key)) {
+      deserialize(*body, response);
+      return;
+    }
+  }
+
+  report.compress = compressor->compress(request_body);
+  LimiterSlot slot(*limiter, request.priority);
+  with_retries(*retrier, *limiter, [&] {
+    auto lease = pool->acquire();
+    response.clear();
+    std::string captured;
+    ++report.attempt;
+    auto started = Clock::now();
+    perform_decode<PmrResponseDecoder>(lease.get(), responses_url,
+                                       request_body, response,
+                                       key ? &captured : nullptr, report);
+    limiter->on_success(Clock::now() - started);
+    if (key) {
+      cache->put(*key, std::move(captured));
+    }
+  });
+}
+
+Engine &OpenRouter::get_engine() {
+  std::call_once(engine_once, [this] {
+    engine = std::make_unique<Engine>(options.connection, options.event_loop);
+  });
+  return *engine;
+}
+
+// Each connection is opened by a HEAD request to the endpoint, which leaves
+// it in the shared cache whatever the status. All but the first force a new
+// connection, so the pool holds `connections` of them afterwards.
+std::future<void> OpenRouter::warm(std::size_t connections) {
+  struct Warmup {
+    std::promise<void> done;
+    std::size_t total = 0;
+    std::size_t remaining = 0;
+    std::size_t failed = 0;
+    CURLcode error = CURLE_OK;
+  };
+
+  auto warmup = std::make_shared<Warmup>();
+  warmup->total = warmup->remaining = connections;
+  auto future = warmup->done.get_future();
+  if (connections == 0) {
+    warmup->done.set_value();
+    return future;
+  }
+
+  Engine &engine = get_engine();
+  for (std::size_t i = 0; i < connections; ++i) {
+    auto transfer = std::make_unique<Engine::Transfer>();
+    transfer->handle = pool->acquire();
+    CURL *handle = transfer->handle.get();
+    curl_easy_setopt(handle, CURLOPT_URL, responses_url.c_str());
+    curl_easy_setopt(handle, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(handle, CURLOPT_FRESH_CONNECT, i > 0 ? 1L : 0L);
+
+    // Runs on the engine thread, so the counters need no lock.
+    transfer->on_complete = [warmup](Engine::Transfer &, CURLcode result) {
+      if (result != CURLE_OK) {
+        ++warmup->failed;
+        warmup->error = result;
+      }
+      if (--warmup->remaining > 0) {
+        return;
+      }
+      if (warmup->failed == warmup->total) {
+        warmup->done.set_exception(
+            std::make_exception_ptr(TransportError(warmup->error)));
+      } else {
+        warmup->done.set_value();
+      }
+    };
+    engine.submit(std::move(transfer));
+  }
+
+  return future;
+}
+
+void OpenRouter::prewarm(std::size_t connections) {
+  warm(connections).get();
+}
+
+// What the attempts of one asynchronous call share: its retries, and the
+// hedge racing the first attempt. Only touched on the engine thread once the
+// first attempt has been submitted.
+struct AsyncCall {
+  Engine &engine;
+  HandlePool &pool;
+  Retrier &retrier;
+  Hedger &hedger;
+  Limiter &limiter;
+  ResponseCache &cache;
+  const RequestHooks &hooks;
+  const std::string &url;
+  ResponseCallback callback;
+  // Kept for the hedge, which needs its own copy of the body.
+  RequestBody request_body;
+  std::optional<CacheKey> cache_key;
+  Clock::duration serialize{};
+  Clock::duration compress{};
+  // When the limiter let the call start, after any delay it imposed.
+  Clock::time_point started{};
+  // When the attempt waiting out a retry delay starts again.
+  std::optional<Clock::time_point> retry_at;
+  std::vector<CURL *> in_flight;
+  int failures = 0;
+  bool hedged = false;
+  bool done = false;
+};
+
+static std::unique_ptr<Engine::Transfer>
+make_attempt(const std::shared_ptr<AsyncCall> &call, RequestBody body) {
+  struct Attempt {
+    Attempt(CURL *handle, bool capture, AttemptReport report)
+        : ctx(response, handle) {
+      if (capture) {
+        ctx.captured = &captured;
+      }
+      ctx.report = report;
+    }
+
+    Response response;
+    std::string captured;
+    DecodeContext<ResponseDecoder> ctx;
+  };
+
+  auto transfer = std::make_unique<Engine::Transfer>();
+  transfer->handle = call->pool.acquire();
+  transfer->request_body = std::move(body);
+
+  CURL *handle = transfer->handle.get();
+  bool capture = call->cache_key.has_value();
+  auto attempt = std::make_shared<Attempt>(
+      handle, capture,
+      AttemptReport{&call->hooks, call->failures + 1, call->serialize,
+                    call->compress});
+  configure_decode(handle, call->url, transfer->request_body, attempt->ctx);
+  call->in_flight.push_back(handle);
+
+  transfer->on_complete = [call, attempt, capture](Engine::Transfer &transfer,
+                                                   CURLcode result) mutable {
+    CURL *handle = transfer.handle.get();
+    std::erase(call->in_flight, handle);
+    if (call->done) {
+      return;
+    }
+
+    try {
+      attempt->ctx.finish(result);
+    } catch (...) {
+      auto error = std::current_exception();
+      call->limiter.on_failure(error);
+      // The other attempt of a hedged pair may still succeed.
+      if (!call->in_flight.empty()) {
+        return;
+      }
+
+      if (auto delay = call->retrier.next_delay(++call->failures, error)) {
+        attempt = std::make_shared<Attempt>(
+            handle, capture,
+            AttemptReport{&call->hooks, call->failures + 1, call->serialize,
+                          call->compress});
+        configure_decode(handle, call->url, transfer.request_body,
+                         attempt->ctx);
+        call->in_flight.push_back(handle);
+        call->retry_at = Engine::Clock::now() + *delay;
+        transfer.resubmit_after = *delay;
+        return;
+      }
+
+      call->done = true;
+      call->limiter.release();
+      call->callback(std::unexpected(error));
+      return;
+    }
+
+    call->done = true;
+    // From the start of the call, so that failed attempts and the wait
+    // before a hedge count against the latency.
+    auto latency = Engine::Clock::now() - call->started;
+    call->hedger.record(latency);
+    call->limiter.on_success(latency);
+    call->limiter.release();
+    if (call->cache_key) {
+      call->cache.put(*call->cache_key, std::move(attempt->captured));
+    }
+    for (CURL *loser : std::exchange(call->in_flight, {})) {
+      call->engine.cancel(loser);
+    }
+    call->callback(std::move(attempt->response));
+  };
+
+  return transfer;
+}
+
+void OpenRouter::create_response_async(const Request &request,
+                                       ResponseCallback callback) {
+  if (request.stream.value_or(false)) {
+    throw std::runtime_error(
+        "Streaming requests are not supported by create_response_async");
+  }
+
+  if (options.hooks.before_request) {
+    options.hooks.before_request(request);
+  }
+
+  auto call = std::make_shared<AsyncCall>(
+      AsyncCall{get_engine(), *pool, *retrier, *hedger, *limiter, *cache,
+                options.hooks, responses_url, std::move(callback), {}, {}, {},
+                {}, {}, {}, {}});
+  call->serialize = write_body(call->request_body, request);
+
+  if (cache->enabled()) {
+    call->cache_key = ResponseCache::key(call->request_body);
+    if (auto body = cache->get(*call->cache_key)) {
+      // Hits are still answered on the event-loop thread.
+      call->engine.schedule({}, [call, body](bool aborted) {
+        ResponseResult result;
+        try {
+          if (aborted) {
+            throw TransportError(CURLE_ABORTED_BY_CALLBACK);
+          }
+          deserialize(*body, *result);
+        } catch (...) {
+          result = std::unexpected(std::current_exception());
+        }
+        call->callback(std::move(result));
+      });
+      return;
+    }
+  }
+
+  call->compress = compressor->compress(call->request_body);
+
+  // Runs once the limiter grants a slot, possibly on another thread.
+  limiter->acquire(request.priority, [call](Engine::Clock::duration delay) {
+    std::unique_ptr<Engine::Transfer> primary;
+    std::optional<Engine::Clock::duration> hedge_after;
+    try {
+      call->started = Engine::Clock::now() + delay;
+      call->retrier.record_request();
+      hedge_after = call->hedger.start_call();
+      primary = make_attempt(call, hedge_after
+                                       ? call->request_body
+                                       : std::move(call->request_body));
+    } catch (...) {
+      // Nothing has reached the engine yet. Rethrowing hands the slot back
+      // to the limiter.
+      call->done = true;
+      call->callback(std::unexpected(std::current_exception()));
+      throw;
+    }
+
+    if (hedge_after) {
+      call->engine.schedule(delay + *hedge_after, [call](bool aborted) {
+        // An attempt waiting out a retry delay is not slow, only failed;
+        // hedging it would just double the retry.
+        bool retrying =
+            call->retry_at && *call->retry_at > Engine::Clock::now();
+        if (aborted || call->done || call->hedged || call->in_flight.empty() ||
+            retrying || !call->hedger.try_hedge()) {
+          return;
+        }
+        call->hedged = true;
+        call->engine.start(make_attempt(call, std::move(call->request_body)));
+      });
+    }
+
+    call->engine.submit(std::move(primary), delay);
+  });
+}
+
+std::future<Response> OpenRouter::create_response_async(const Request &request) {
+  auto promise = std::make_shared<std::promise<Response>>();
+  auto future = promise->get_future();
+
+  create_response_async(
+      request,
+      [promise](ResponseResult response) {
+        if (response) {
+          promise->set_value(std::move(*response));
+        } else {
+          promise->set_exception(response.error());
+        }
+      });
+
+  return future;
+}
+
+// The call's callback and the awaiting coroutine both mark their arrival;
+// whichever comes second resumes the coroutine.
+struct ResponseAwaitable::State {
+  ResponseResult result;
+  std::coroutine_handle<> waiter;
+  std::atomic<bool> arrived = false;
+};
+
+ResponseAwaitable::ResponseAwaitable(std::shared_ptr<State> state)
+    : state(std::move(state)) {}
+
+bool ResponseAwaitable::await_ready() const noexcept {
+  return state->arrived.load();
+}
+
+bool ResponseAwaitable::await_suspend(std::coroutine_handle<> waiter) {
+  state->waiter = waiter;
+  return !state->arrived.exchange(true);
+}
+
+Response ResponseAwaitable::await_resume() {
+  if (!state->result) {
+    std::rethrow_exception(state->result.error());
+  }
+  return std::move(*state->result);
+}
+
+ResponseAwaitable OpenRouter::co_create_response(const Request &request) {
+  auto state = std::make_shared<ResponseAwaitable::State>();
+  create_response_async(request, [state](ResponseResult result) {
+    state->result = std::move(result);
+    if (state->arrived.exchange(true)) {
+      state->waiter.resume();
+    }
+  });
+  return ResponseAwaitable(std::move(state));
+}
+
+// Shared with the callbacks, which may still be returning on the engine
+// thread after the caller has woken up.
+struct BulkCall {
+  BulkCall(std::size_t size, std::size_t max_in_flight)
+      : results(size), slots(static_cast<std::ptrdiff_t>(max_in_flight)),
+        finished(static_cast<std::ptrdiff_t>(size)) {}
+
+  std::vector<ResponseResult> results;
+  std::counting_semaphore<> slots;
+  std::latch finished;
+  std::atomic<std::size_t> completed = 0;
+};
+
+std::vector<ResponseResult>
+OpenRouter::create_responses(std::span<const Request> requests,
+                             const BulkOptions &options) {
+  auto bulk = std::make_shared<BulkCall>(
+      requests.size(), std::max<std::size_t>(1, options.max_in_flight));
+
+  auto finish = [bulk, &options, total = requests.size()](
+                    std::size_t index, ResponseResult result) {
+    bulk->results[index] = std::move(result);
+    if (options.on_progress) {
+      options.on_progress(++bulk->completed, total);
+    }
+    bulk->slots.release();
+    bulk->finished.count_down();
+  };
+
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    bulk->slots.acquire();
+    try {
+      create_response_async(requests[i], [finish, i](ResponseResult result) {
+        finish(i, std::move(result));
+      });
+    } catch (...) {
+      finish(i, std::unexpected(std::current_exception()));
+    }
+  }
+
+  bulk->finished.wait();
+  return std::move(bulk->results);
+}
+
+struct StreamContext {
+  CURL *curl;
+  SSEParser parser;
+  std::string error_body;
+  std::exception_ptr error;
+};
+
+static size_t stream_write_callback(char *ptr, size_t size, size_t nmemb,
+                                    StreamContext *ctx) {
+  if (response_code(ctx->curl) >= 400) {
+    append_error_body(ctx->error_body, ptr, size * nmemb);
+    return size * nmemb;
+  }
+
+  try {
+    ctx->parser.feed(std::string_view(ptr, size * nmemb));
+  } catch (...) {
+    ctx->error = std::current_exception();
+    return 0;
+  }
+
+  return size * nmemb;
+}
+
+static void dispatch_stream_event(const SSEParser::Event &event,
+                                  const StreamCallback &on_event,
+                                  std::optional<Response> &completed,
+                                  bool &delivered, Clock::duration &parse) {
+  if (event.data == "[DONE]") {
+    return;
+  }
+
+  auto started = Clock::now();
+  nlohmann::json json = nlohmann::json::parse(event.data);
+  parse += Clock::now() - started;
+  std::string_view name = event.type;
+  if (auto field = json.find("type"); field != json.end()) {
+    name = field->get_ref<const std::string &>();
+  }
+  auto type = stream_event_types.find(name);
+  // Errors are recognised by their payload as well as their type.
+  if (!type && json.contains("error")) {
+    type = StreamEventType::Error;
+  }
+  if (!type) {
+    return;
+  }
+
+  switch (*type) {
+  case StreamEventType::OutputTextDelta:
+    delivered = true;
+    on_event(json.get<ResponseOutputTextDelta>());
+    break;
+  case StreamEventType::FunctionCallArgumentsDelta:
+    delivered = true;
+    on_event(json.get<ResponseFunctionCallArgumentsDelta>());
+    break;
+  case StreamEventType::ReasoningTextDelta:
+    delivered = true;
+    on_event(json.get<ResponseReasoningTextDelta>());
+    break;
+  case StreamEventType::ReasoningSummaryTextDelta:
+    delivered = true;
+    on_event(json.get<ResponseReasoningSummaryTextDelta>());
+    break;
+  case StreamEventType::Completed: {
+    delivered = true;
+    ResponseStreamEvent stream_event = json.get<ResponseCompleted>();
+    on_event(stream_event);
+    completed = std::move(std::get<ResponseCompleted>(stream_event).response);
+    break;
+  }
+  case StreamEventType::Failed:
+    throw std::runtime_error(std::format("OpenRouter API error: {}",
+                                         error_message(json["response"])));
+  case StreamEventType::Error:
+    throw std::runtime_error(
+        std::format("OpenRouter API error: {}", error_message(json)));
+  }
+}
+
+// A stream is only retried until its first event reaches the callback.
+Response OpenRouter::create_response(const Request &request,
+                                     const StreamCallback &on_event) {
+  if (options.hooks.before_request) {
+    options.hooks.before_request(request);
+  }
+
+  RequestBody request_body;
+  AttemptReport report{&options.hooks, 0,
+                       write_body(request_body, request, true)};
+  report.compress = compressor->compress(request_body);
+
+  LimiterSlot slot(*limiter, request.priority);
+  bool delivered = false;
+  return with_retries(
+      *retrier, *limiter,
+      [&] {
+        auto lease = pool->acquire();
+        std::optional<Response> completed;
+        ++report.attempt;
+        report.parse = {};
+        // Streams feed the limiter their time to first event, the part of
+        // their latency that congestion shows in.
+        auto started = Clock::now();
+        std::optional<Clock::duration> first_event;
+        StreamContext ctx{
+            lease.get(),
+            SSEParser([&](const SSEParser::Event &event) {
+              if (!first_event) {
+                first_event = Clock::now() - started;
+              }
+              dispatch_stream_event(event, on_event, completed, delivered,
+                                    report.parse);
+            }),
+            {},
+            {},
+        };
+
+        CURLcode res = http_post(
+            lease.get(), responses_url, request_body,
+            reinterpret_cast<curl_write_callback>(stream_write_callback),
+            &ctx);
+        try {
+          if (ctx.error) {
+            std::rethrow_exception(ctx.error);
+          }
+          if (res != CURLE_OK) {
+            throw TransportError(res);
+          }
+          if (long status = response_code(lease.get()); status >= 400) {
+            throw http_error(lease.get(), status, ctx.error_body);
+          }
+
+          ctx.parser.finish();
+          if (!completed) {
+            throw std::runtime_error(
+                "OpenRouter stream ended before completion");
+          }
+        } catch (...) {
+          report.publish(lease.get(), std::current_exception());
+          throw;
+        }
+
+        report.publish(lease.get(), nullptr);
+        limiter->on_success(*first_event, Limiter::Sample::FirstEvent);
+        return std::move(*completed);
+      },
+      delivered);
+}
+
+LimiterStats OpenRouter::limiter_stats() const { return limiter->stats(); }
+
+CacheStats OpenRouter::cache_stats() const { return cache->stats(); }
+
+ConnectionStats OpenRouter::connection_stats() const {
+  return pool->stats();
+}
+
+CompressionStats OpenRouter::compression_stats() const {
+  return compressor->stats();
 }
 
 } // namespace openrouter
@@ -0,0 +1,22 @@
+#include "openrouter/pmr.hpp"
+
+namespace openrouter::pmr {
+
+Response::Response(std::size_t initial_size)
+    : arena(std::make_unique<std::pmr::monotonic_buffer_resource>(
+          initial_size)) {}
+
+// The output has to go before the arena it was allocated from.
+Response &Response::operator=(Response &&other) noexcept {
+  output.reset();
+  arena = std::move(other.arena);
+  output = std::move(other.output);
+  return *this;
+}
+
+void Response::clear() {
+  output.reset();
+  arena->release();
+}
+
+} // namespace openrouter::pmr
@@ -0,0 +1,120 @@
+#include "request_body.hpp"
+#include "openrouter/base64.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace openrouter {
+
+// Encodes the slice [pos, pos + capacity) of the base64 form of `bytes`.
+// Whole groups go straight into the destination; a group cut by either end
+// of the slice is encoded into a scratch quad first.
+static size_t encode_range(std::span<const std::byte> bytes, size_t pos,
+                           char *dest, size_t capacity) {
+  size_t end = std::min(base64_encoded_size(bytes.size()), pos + capacity);
+  char *out = dest;
+
+  while (pos < end) {
+    size_t first = pos / 4 * 3;
+    size_t in_group = pos % 4;
+
+    if (in_group == 0 && end - pos >= 4) {
+      size_t length = std::min((end - pos) / 4 * 3, bytes.size() - first);
+      base64_encode(bytes.subspan(first, length), out);
+      size_t n = base64_encoded_size(length);
+      out += n;
+      pos += n;
+    } else {
+      char quad[4];
+      base64_encode(
+          bytes.subspan(first, std::min<size_t>(3, bytes.size() - first)),
+          quad);
+      size_t n = std::min<size_t>(4 - in_group, end - pos);
+      std::memcpy(out, quad + in_group, n);
+      out += n;
+      pos += n;
+    }
+  }
+
+  return out - dest;
+}
+
+RequestBody::RequestBody() { segments.emplace_back(std::string()); }
+
+void RequestBody::append(Attachment attachment) {
+  segments.emplace_back(std::move(attachment));
+  segments.emplace_back(std::string());
+}
+
+void RequestBody::append(const RequestBody &other) {
+  text().append(std::get<std::string>(other.segments.front()));
+  segments.insert(segments.end(), other.segments.begin() + 1,
+                  other.segments.end());
+}
+
+void RequestBody::flatten(std::string &out) const {
+  for (const auto &item : segments) {
+    if (auto text = std::get_if<std::string>(&item)) {
+      out.append(*text);
+    } else {
+      out.append(std::get<Attachment>(item).encode(false));
+    }
+  }
+}
+
+void RequestBody::truncate(Mark mark) {
+  segments.resize(mark.segments);
+  text().resize(mark.text);
+  rewind();
+}
+
+void RequestBody::clear() {
+  segments.resize(1);
+  text().clear();
+  segment = 0;
+  offset = 0;
+  header_list = nullptr;
+}
+
+size_t RequestBody::size() const {
+  size_t total = 0;
+  for (const auto &item : segments) {
+    if (auto text = std::get_if<std::string>(&item)) {
+      total += text->size();
+    } else {
+      total += base64_encoded_size(std::get<Attachment>(item).bytes().size());
+    }
+  }
+  return total;
+}
+
+size_t RequestBody::read(char *buffer, size_t size) {
+  size_t written = 0;
+  while (written < size && segment < segments.size()) {
+    size_t length;
+    size_t n;
+    if (auto text = std::get_if<std::string>(&segments[segment])) {
+      length = text->size();
+      n = std::min(size - written, length - offset);
+      std::memcpy(buffer + written, text->data() + offset, n);
+    } else {
+      auto bytes = std::get<Attachment>(segments[segment]).bytes();
+      length = base64_encoded_size(bytes.size());
+      n = encode_range(bytes, offset, buffer + written, size - written);
+    }
+
+    written += n;
+    offset += n;
+    if (offset == length) {
+      ++segment;
+      offset = 0;
+    }
+  }
+  return written;
+}
+
+void RequestBody::rewind() {
+  segment = 0;
+  offset = 0;
+}
+
+} // namespace openrouter
@@ -0,0 +1,61 @@
+#pragma once
+#include "openrouter/attachment.hpp"
+#include <cstddef>
+#include <curl/curl.h>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace openrouter {
+
+// A request body made of JSON text interleaved with attachments. The
+// attachments are base64-encoded on the fly while curl reads the body, so
+// their encoded form never exists in memory as a whole.
+class RequestBody {
+public:
+  RequestBody();
+
+  // The text segment currently being appended to. Invalidated by
+  // append(Attachment).
+  std::string &text() { return std::get<std::string>(segments.back()); }
+  void append(Attachment attachment);
+  // Appends the segments of `other`, sharing its attachments.
+  void append(const RequestBody &other);
+  // Appends the whole body to `out` with its attachments encoded in place.
+  void flatten(std::string &out) const;
+
+  // Where the body ends, for truncate() to cut it back to.
+  struct Mark {
+    size_t segments;
+    size_t text;
+  };
+  Mark end() const {
+    return {segments.size(), std::get<std::string>(segments.back()).size()};
+  }
+  void truncate(Mark mark);
+
+  void clear();
+  bool contiguous() const { return segments.size() == 1; }
+  bool empty() const {
+    return contiguous() && std::get<std::string>(segments[0]).empty();
+  }
+  size_t size() const;
+
+  size_t read(char *buffer, size_t size);
+  void rewind();
+
+  // Sent in place of the client's default headers when set, for bodies that
+  // need their own, such as a Content-Encoding. Not owned.
+  const curl_slist *headers() const { return header_list; }
+  void set_headers(const curl_slist *list) { header_list = list; }
+
+private:
+  using Segment = std::variant<std::string, Attachment>;
+
+  std::vector<Segment> segments;
+  size_t segment = 0;
+  size_t offset = 0;
+  const curl_slist *header_list = nullptr;
+};
+
+} // namespace openrouter
@@ -0,0 +1,54 @@
+#include "openrouter/responses.hpp"
+#include "json_writer.hpp"
+
+namespace openrouter {
+
+struct RequestPrefix::Frozen {
+  std::optional<std::string> model;
+  std::vector<OpenResponsesInput> input;
+  std::string members;
+  RequestBody items;
+};
+
+RequestPrefix::RequestPrefix(const Request &shared) {
+  auto state = std::make_shared<Frozen>();
+  state->model = shared.model;
+
+  if (shared.input) {
+    if (auto text = std::get_if<std::string>(&*shared.input)) {
+      state->input.push_back(OpenResponsesEasyInputMessage{
+          OpenResponsesEasyInputMessage::User, {InputText{*text}}});
+    } else {
+      state->input = std::get<std::vector<OpenResponsesInput>>(*shared.input);
+    }
+  }
+
+  if (state->model) {
+    JsonWriter w(state->members);
+    w.key("model");
+    w.value(*state->model);
+  }
+
+  JsonWriter w(state->items);
+  for (const auto &item : state->input) {
+    write(w, item);
+  }
+
+  frozen = std::move(state);
+}
+
+const std::optional<std::string> &RequestPrefix::model() const {
+  return frozen->model;
+}
+
+const std::vector<OpenResponsesInput> &RequestPrefix::input() const {
+  return frozen->input;
+}
+
+std::string_view RequestPrefix::members_json() const {
+  return frozen->members;
+}
+
+const RequestBody &RequestPrefix::items_body() const { return frozen->items; }
+
+} // namespace openrouter
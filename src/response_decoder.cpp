@@ -0,0 +1,433 @@
+#include "response_decoder.hpp"
+#include "openrouter/serializer.hpp"
+#include "tags.hpp"
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+namespace openrouter {
+
+template <typename Status> static Status item_status(std::string_view status) {
+  return item_statuses<Status>.parse(status);
+}
+
+template <typename Status>
+static Status search_status(std::string_view status) {
+  return search_statuses<Status>.parse(status);
+}
+
+template <typename Status, typename String>
+static std::optional<Status>
+optional_item_status(const std::optional<String> &status) {
+  if (!status) {
+    return std::nullopt;
+  }
+  return item_status<Status>(*status);
+}
+
+template <typename Types>
+BasicResponseDecoder<Types>::BasicResponseDecoder(Response &response)
+    : response(response), alloc(Types::allocator(response)) {}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::null() { return true; }
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::boolean(bool) { return true; }
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::number_integer(std::int64_t value) {
+  return number(static_cast<double>(value));
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::number_unsigned(std::uint64_t value) {
+  return number(static_cast<double>(value));
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::number_float(double value,
+                                               const std::string &) {
+  return number(value);
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::string(std::string &value) {
+  return this->value(std::move(value));
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::binary(nlohmann::json::binary_t &) {
+  return true;
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::key(std::string &value) {
+  if (skip_depth == 0) {
+    current_key = std::move(value);
+  }
+  return true;
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::start_object(std::size_t) {
+  if (skip_depth > 0) {
+    ++skip_depth;
+    return true;
+  }
+
+  if (stack.empty()) {
+    stack.push_back(Frame::Root);
+    return true;
+  }
+
+  switch (stack.back()) {
+  case Frame::Root:
+    if (current_key == "error") {
+      error_message.emplace();
+      stack.push_back(Frame::Error);
+      return true;
+    }
+    break;
+  case Frame::Output:
+    item = ItemFields(alloc);
+    stack.push_back(Frame::Item);
+    return true;
+  case Frame::Parts:
+    part = PartFields(alloc);
+    stack.push_back(Frame::Part);
+    return true;
+  case Frame::Annotations:
+    annotation = AnnotationFields(alloc);
+    stack.push_back(Frame::Annotation);
+    return true;
+  case Frame::Summary:
+    summary_text.clear();
+    stack.push_back(Frame::SummaryPart);
+    return true;
+  default:
+    break;
+  }
+
+  skip_depth = 1;
+  return true;
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::end_object() {
+  if (skip_depth > 0) {
+    --skip_depth;
+    return true;
+  }
+
+  Frame frame = stack.back();
+  stack.pop_back();
+
+  switch (frame) {
+  case Frame::Item:
+    finish_item();
+    break;
+  case Frame::Part:
+    item.parts->push_back(std::move(part));
+    break;
+  case Frame::Annotation:
+    finish_annotation();
+    break;
+  case Frame::SummaryPart:
+    item.summary.push_back(std::move(summary_text));
+    break;
+  default:
+    break;
+  }
+
+  return true;
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::start_array(std::size_t) {
+  if (skip_depth > 0) {
+    ++skip_depth;
+    return true;
+  }
+
+  if (!stack.empty()) {
+    switch (stack.back()) {
+    case Frame::Root:
+      if (current_key == "output") {
+        response.output.emplace(alloc);
+        stack.push_back(Frame::Output);
+        return true;
+      }
+      break;
+    case Frame::Item:
+      if (current_key == "content") {
+        item.parts.emplace(alloc);
+        stack.push_back(Frame::Parts);
+        return true;
+      } else if (current_key == "summary") {
+        stack.push_back(Frame::Summary);
+        return true;
+      } else if (current_key == "queries") {
+        stack.push_back(Frame::Queries);
+        return true;
+      }
+      break;
+    case Frame::Part:
+      if (current_key == "annotations") {
+        part.annotations.emplace(alloc);
+        stack.push_back(Frame::Annotations);
+        return true;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  skip_depth = 1;
+  return true;
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::end_array() {
+  if (skip_depth > 0) {
+    --skip_depth;
+    return true;
+  }
+
+  stack.pop_back();
+  return true;
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::parse_error(
+    std::size_t, const std::string &, const nlohmann::detail::exception &ex) {
+  throw ex;
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::value(std::string &&text) {
+  if (skip_depth > 0 || stack.empty()) {
+    return true;
+  }
+
+  if (stack.back() == Frame::Error) {
+    if (current_key == "message") {
+      error_message = std::move(text);
+    }
+    return true;
+  }
+
+  String value = Types::string(std::move(text), alloc);
+  switch (stack.back()) {
+  case Frame::Item:
+    if (current_key == "type") {
+      item.type = std::move(value);
+    } else if (current_key == "id") {
+      item.id = std::move(value);
+    } else if (current_key == "status") {
+      item.status = std::move(value);
+    } else if (current_key == "arguments") {
+      item.arguments = std::move(value);
+    } else if (current_key == "call_id") {
+      item.call_id = std::move(value);
+    } else if (current_key == "name") {
+      item.name = std::move(value);
+    } else if (current_key == "encrypted_content") {
+      item.encrypted_content = std::move(value);
+    } else if (current_key == "result") {
+      item.result = std::move(value);
+    }
+    break;
+  case Frame::Part:
+    if (current_key == "type") {
+      part.type = std::move(value);
+    } else if (current_key == "text") {
+      part.text = std::move(value);
+    } else if (current_key == "refusal") {
+      part.refusal = std::move(value);
+    }
+    break;
+  case Frame::Annotation:
+    if (current_key == "type") {
+      annotation.type = std::move(value);
+    } else if (current_key == "file_id") {
+      annotation.file_id = std::move(value);
+    } else if (current_key == "filename") {
+      annotation.filename = std::move(value);
+    } else if (current_key == "url") {
+      annotation.url = std::move(value);
+    } else if (current_key == "title") {
+      annotation.title = std::move(value);
+    }
+    break;
+  case Frame::SummaryPart:
+    if (current_key == "text") {
+      summary_text = std::move(value);
+    }
+    break;
+  case Frame::Queries:
+    item.queries.push_back(std::move(value));
+    break;
+  default:
+    break;
+  }
+
+  return true;
+}
+
+template <typename Types>
+bool BasicResponseDecoder<Types>::number(double value) {
+  if (skip_depth > 0 || stack.empty() || stack.back() != Frame::Annotation) {
+    return true;
+  }
+
+  if (current_key == "index") {
+    annotation.index = value;
+  } else if (current_key == "start_index") {
+    annotation.start_index = value;
+  } else if (current_key == "end_index") {
+    annotation.end_index = value;
+  }
+
+  return true;
+}
+
+template <typename Types>
+void BasicResponseDecoder<Types>::finish_annotation() {
+  using OutputText = typename Types::OutputText;
+
+  switch (annotation_types.parse(annotation.type)) {
+  case AnnotationType::FileCitation:
+    part.annotations->push_back(typename OutputText::FileCitation{
+        std::move(annotation.file_id), std::move(annotation.filename),
+        annotation.index});
+    break;
+  case AnnotationType::URLCitation:
+    part.annotations->push_back(typename OutputText::URLCitation{
+        std::move(annotation.url), std::move(annotation.title),
+        annotation.start_index, annotation.end_index});
+    break;
+  case AnnotationType::FilePath:
+    part.annotations->push_back(typename OutputText::FilePath{
+        std::move(annotation.file_id), annotation.index});
+    break;
+  }
+}
+
+// Items are built with designated initializers so every member is
+// move-constructed from scratch state and keeps the decoder's allocator.
+template <typename Types>
+void BasicResponseDecoder<Types>::finish_item() {
+  auto &output = *response.output;
+
+  switch (output_item_types.parse(item.type)) {
+  case OutputItemType::Message: {
+    using Message = typename Types::Message;
+    decltype(Message::content) content(alloc);
+    if (item.parts) {
+      for (auto &part : *item.parts) {
+        switch (output_content_types.parse(part.type)) {
+        case OutputContentType::OutputText:
+          content.push_back(typename Types::OutputText{
+              std::move(part.text), std::move(part.annotations)});
+          break;
+        case OutputContentType::Refusal:
+          content.push_back(typename Types::Refusal{std::move(part.refusal)});
+          break;
+        }
+      }
+    }
+    output.push_back(Message{
+        .content = std::move(content),
+        .id = std::move(item.id).value_or(String(alloc)),
+        .status = optional_item_status<typename Message::Status>(item.status),
+    });
+    break;
+  }
+  case OutputItemType::Reasoning: {
+    using Reasoning = typename Types::Reasoning;
+    std::optional<Vector<String>> content;
+    if (item.parts) {
+      content.emplace(alloc);
+      for (auto &part : *item.parts) {
+        content->push_back(std::move(part.text));
+      }
+    }
+    output.push_back(Reasoning{
+        .id = std::move(item.id).value_or(String(alloc)),
+        .summary = std::move(item.summary),
+        .content = std::move(content),
+        .encrypted_content = std::move(item.encrypted_content),
+        .status =
+            optional_item_status<typename Reasoning::Status>(item.status),
+    });
+    break;
+  }
+  case OutputItemType::FunctionCall: {
+    using FunctionCall = typename Types::FunctionCall;
+    output.push_back(FunctionCall{
+        .arguments = std::move(item.arguments),
+        .call_id = std::move(item.call_id),
+        .name = std::move(item.name),
+        .id = std::move(item.id),
+        .status =
+            optional_item_status<typename FunctionCall::Status>(item.status),
+    });
+    break;
+  }
+  case OutputItemType::WebSearchCall: {
+    using WebSearchCall = typename Types::WebSearchCall;
+    output.push_back(WebSearchCall{
+        .id = std::move(item.id).value_or(String(alloc)),
+        .status = search_status<typename WebSearchCall::Status>(
+            item.status.value_or("")),
+    });
+    break;
+  }
+  case OutputItemType::FileSearchCall: {
+    using FileSearchCall = typename Types::FileSearchCall;
+    output.push_back(FileSearchCall{
+        .id = std::move(item.id).value_or(String(alloc)),
+        .queries = std::move(item.queries),
+        .status = search_status<typename FileSearchCall::Status>(
+            item.status.value_or("")),
+    });
+    break;
+  }
+  case OutputItemType::ImageGenerationCall: {
+    output.push_back(typename Types::ImageGenerationCall{
+        .id = std::move(item.id).value_or(String(alloc)),
+        .status = image_generation_statuses.parse(item.status.value_or("")),
+        .result = std::move(item.result),
+    });
+    break;
+  }
+  }
+}
+
+template class BasicResponseDecoder<ResponseTypes>;
+template class BasicResponseDecoder<PmrResponseTypes>;
+
+template <typename Decoder>
+static void decode(std::string_view json,
+                   typename Decoder::Response &response) {
+  Decoder decoder(response);
+  nlohmann::json::sax_parse(json.begin(), json.end(), &decoder);
+
+  if (decoder.error()) {
+    throw std::runtime_error(
+        std::format("OpenRouter API error: {}", *decoder.error()));
+  }
+}
+
+void deserialize(std::string_view json, Response &response) {
+  decode<ResponseDecoder>(json, response);
+}
+
+void deserialize(std::string_view json, pmr::Response &response) {
+  response.clear();
+  decode<PmrResponseDecoder>(json, response);
+}
+
+} // namespace openrouter
@@ -0,0 +1,175 @@
+#pragma once
+#include "openrouter/pmr.hpp"
+#include "openrouter/responses.hpp"
+#include "nlohmann/json.hpp"
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openrouter {
+
+// The type families a decoder can fill: the regular response types, or the
+// arena-backed mirrors in openrouter::pmr.
+struct ResponseTypes {
+  using Response = openrouter::Response;
+  using Allocator = std::allocator<char>;
+  using String = std::string;
+  template <typename T> using Vector = std::vector<T>;
+
+  using OutputText = ResponseOutputText;
+  using Refusal = OpenAIResponsesRefusalContent;
+  using Message = ResponsesOutputMessage;
+  using Reasoning = ResponsesOutputItemReasoning;
+  using FunctionCall = ResponsesOutputItemFunctionCall;
+  using WebSearchCall = ResponsesWebSearchCallOutput;
+  using FileSearchCall = ResponsesOutputItemFileSearchCall;
+  using ImageGenerationCall = ResponsesImageGenerationCall;
+
+  static Allocator allocator(Response &) { return {}; }
+  static String string(std::string &&text, const Allocator &) {
+    return std::move(text);
+  }
+};
+
+struct PmrResponseTypes {
+  using Response = pmr::Response;
+  using Allocator = std::pmr::polymorphic_allocator<char>;
+  using String = std::pmr::string;
+  template <typename T> using Vector = std::pmr::vector<T>;
+
+  using OutputText = pmr::ResponseOutputText;
+  using Refusal = pmr::OpenAIResponsesRefusalContent;
+  using Message = pmr::ResponsesOutputMessage;
+  using Reasoning = pmr::ResponsesOutputItemReasoning;
+  using FunctionCall = pmr::ResponsesOutputItemFunctionCall;
+  using WebSearchCall = pmr::ResponsesWebSearchCallOutput;
+  using FileSearchCall = pmr::ResponsesOutputItemFileSearchCall;
+  using ImageGenerationCall = pmr::ResponsesImageGenerationCall;
+
+  static Allocator allocator(Response &response) {
+    return response.get_allocator();
+  }
+  // Copies into the arena; the parser keeps its buffer for the next value.
+  static String string(std::string &&text, const Allocator &allocator) {
+    return String(text, allocator);
+  }
+};
+
+// nlohmann SAX handler that fills a Response directly from parser events,
+// moving strings out of the parser instead of going through a DOM. Fields
+// the library does not model are skipped without being materialized. Scratch
+// state uses the target's allocator so finished values move into the
+// response without a copy.
+template <typename Types> class BasicResponseDecoder {
+public:
+  using Response = typename Types::Response;
+  using Allocator = typename Types::Allocator;
+  using String = typename Types::String;
+  template <typename T> using Vector = typename Types::template Vector<T>;
+
+  explicit BasicResponseDecoder(Response &response);
+
+  bool null();
+  bool boolean(bool value);
+  bool number_integer(std::int64_t value);
+  bool number_unsigned(std::uint64_t value);
+  bool number_float(double value, const std::string &text);
+  bool string(std::string &value);
+  bool binary(nlohmann::json::binary_t &value);
+  bool start_object(std::size_t elements);
+  bool key(std::string &value);
+  bool end_object();
+  bool start_array(std::size_t elements);
+  bool end_array();
+  bool parse_error(std::size_t position, const std::string &token,
+                   const nlohmann::detail::exception &ex);
+
+  // Set when the body carried an API error object instead of a response.
+  const std::optional<std::string> &error() const { return error_message; }
+
+private:
+  enum class Frame {
+    Root,
+    Error,
+    Output,
+    Item,
+    Parts,
+    Part,
+    Annotations,
+    Annotation,
+    Summary,
+    SummaryPart,
+    Queries,
+  };
+
+  struct AnnotationFields {
+    explicit AnnotationFields(const Allocator &alloc)
+        : type(alloc), file_id(alloc), filename(alloc), url(alloc),
+          title(alloc) {}
+
+    String type;
+    String file_id;
+    String filename;
+    String url;
+    String title;
+    double index = 0;
+    double start_index = 0;
+    double end_index = 0;
+  };
+
+  struct PartFields {
+    explicit PartFields(const Allocator &alloc)
+        : type(alloc), text(alloc), refusal(alloc) {}
+
+    String type;
+    String text;
+    String refusal;
+    std::optional<Vector<typename Types::OutputText::Annotation>> annotations;
+  };
+
+  struct ItemFields {
+    explicit ItemFields(const Allocator &alloc)
+        : type(alloc), arguments(alloc), call_id(alloc), name(alloc),
+          summary(alloc), queries(alloc) {}
+
+    String type;
+    std::optional<String> id;
+    std::optional<String> status;
+    String arguments;
+    String call_id;
+    String name;
+    std::optional<String> encrypted_content;
+    std::optional<String> result;
+    std::optional<Vector<PartFields>> parts;
+    Vector<String> summary;
+    Vector<String> queries;
+  };
+
+  bool value(std::string &&text);
+  bool number(double value);
+  void finish_item();
+  void finish_annotation();
+
+  Response &response;
+  Allocator alloc;
+  std::vector<Frame> stack;
+  std::string current_key;
+  int skip_depth = 0;
+
+  ItemFields item{alloc};
+  PartFields part{alloc};
+  AnnotationFields annotation{alloc};
+  String summary_text{alloc};
+  std::optional<std::string> error_message;
+};
+
+extern template class BasicResponseDecoder<ResponseTypes>;
+extern template class BasicResponseDecoder<PmrResponseTypes>;
+
+using ResponseDecoder = BasicResponseDecoder<ResponseTypes>;
+using PmrResponseDecoder = BasicResponseDecoder<PmrResponseTypes>;
+
+} // namespace openrouter
@@ -1,9 +1,15 @@
 #include "openrouter/responses.hpp"
 #include "nlohmann/json.hpp"
+#include "tags.hpp"
 #include <stdexcept>
 
 namespace openrouter {
 
+// A string field holding a wire name, read without copying it.
+static std::string_view tag(const nlohmann::json &j) {
+  return j.get_ref<const std::string &>();
+}
+
 void to_json(nlohmann::json &j, const InputText &text) {
   j = nlohmann::json::object();
   j["type"] = "input_text";
@@ -14,21 +20,11 @@ void to_json(nlohmann::json &j, const InputImage &image) {
   j = nlohmann::json::object();
   j["type"] = "input_image";
 
-  switch (image.detail) {
-  case InputImage::Auto:
-    j["detail"] = "auto";
-    break;
-  case InputImage::High:
-    j["detail"] = "high";
-    break;
-  case InputImage::Low:
-    j["detail"] = "low";
-    break;
-  default:
-    throw std::runtime_error("Unknown InputImage detail enum value");
-  }
-
-  if (image.url) {
+  j["detail"] = image_details.name(image.detail);
+
+  if (image.attachment) {
+    j["image_url"] = image.attachment->encode();
+  } else if (image.url) {
     j["image_url"] = *image.url;
   }
 }
@@ -40,7 +36,9 @@ void to_json(nlohmann::json &j, const InputFile &file) {
   if (file.id) {
     j["file_id"] = *file.id;
   }
-  if (file.data) {
+  if (file.attachment) {
+    j["file_data"] = file.attachment->encode();
+  } else if (file.data) {
     j["file_data"] = *file.data;
   }
   if (file.filename) {
@@ -56,18 +54,13 @@ void to_json(nlohmann::json &j, const InputAudio &audio) {
   j["type"] = "input_audio";
 
   j["input_audio"] = nlohmann::json::object();
-  j["input_audio"]["data"] = audio.data;
-
-  switch (audio.format) {
-  case InputAudio::MP3:
-    j["input_audio"]["format"] = "mp3";
-    break;
-  case InputAudio::WAV:
-    j["input_audio"]["format"] = "wav";
-    break;
-  default:
-    throw std::runtime_error("Unknown InputAudio format enum value");
+  if (audio.attachment) {
+    j["input_audio"]["data"] = audio.attachment->encode(false);
+  } else {
+    j["input_audio"]["data"] = audio.data;
   }
+
+  j["input_audio"]["format"] = audio_formats.name(audio.format);
 }
 
 void to_json(nlohmann::json &j,
@@ -104,24 +97,7 @@ void to_json(nlohmann::json &j, const OpenResponsesReasoning &reasoning) {
   }
 
   if (reasoning.format) {
-    if (*reasoning.format == OpenResponsesReasoning::Format::Unknown) {
-      j["format"] = "unknown";
-    } else if (*reasoning.format ==
-               OpenResponsesReasoning::Format::OpenAIResponseV1) {
-      j["format"] = "openai-response-v1";
-    } else if (*reasoning.format ==
-               OpenResponsesReasoning::Format::XAIResponseV1) {
-      j["format"] = "xai-response-v1";
-    } else if (*reasoning.format ==
-               OpenResponsesReasoning::Format::AnthropicClaudeV1) {
-      j["format"] = "anthropic-claude-v1";
-    } else if (*reasoning.format ==
-               OpenResponsesReasoning::Format::GoogleGeminiV1) {
-      j["format"] = "google-gemini-v1";
-    } else {
-      throw std::runtime_error(
-          "Unknown OpenResponsesReasoning format enum value");
-    }
+    j["format"] = reasoning_formats.name(*reasoning.format);
   }
 
   if (reasoning.signature) {
@@ -129,41 +105,15 @@ void to_json(nlohmann::json &j, const OpenResponsesReasoning &reasoning) {
   }
 
   if (reasoning.status) {
-    if (*reasoning.status == OpenResponsesReasoning::Status::Completed) {
-      j["status"] = "completed";
-    } else if (*reasoning.status ==
-               OpenResponsesReasoning::Status::Incomplete) {
-      j["status"] = "incomplete";
-    } else if (*reasoning.status ==
-               OpenResponsesReasoning::Status::InProgress) {
-      j["status"] = "in_progress";
-    } else {
-      throw std::runtime_error(
-          "Unknown OpenResponsesReasoning status enum value");
-    }
+    j["status"] = item_statuses<OpenResponsesReasoning::Status>.name(
+        *reasoning.status);
   }
 }
 
 void to_json(nlohmann::json &j, const OpenResponsesEasyInputMessage &message) {
   j = nlohmann::json::object();
 
-  switch (message.role) {
-  case OpenResponsesEasyInputMessage::User:
-    j["role"] = "user";
-    break;
-  case OpenResponsesEasyInputMessage::System:
-    j["role"] = "system";
-    break;
-  case OpenResponsesEasyInputMessage::Assistant:
-    j["role"] = "assistant";
-    break;
-  case OpenResponsesEasyInputMessage::Developer:
-    j["role"] = "developer";
-    break;
-  default:
-    throw std::runtime_error(
-        "Unknown OpenResponsesEasyInputMessage role enum value");
-  }
+  j["role"] = easy_input_roles.name(message.role);
 
   j["content"] = nlohmann::json::array();
   for (const auto &item : message.content) {
@@ -177,20 +127,7 @@ void to_json(nlohmann::json &j,
              const OpenResponsesInputMessageItem &message_item) {
   j = nlohmann::json::object();
 
-  switch (message_item.role) {
-  case OpenResponsesInputMessageItem::User:
-    j["role"] = "user";
-    break;
-  case OpenResponsesInputMessageItem::System:
-    j["role"] = "system";
-    break;
-  case OpenResponsesInputMessageItem::Developer:
-    j["role"] = "developer";
-    break;
-  default:
-    throw std::runtime_error(
-        "Unknown OpenResponsesInputMessageItem role enum value");
-  }
+  j["role"] = input_item_roles.name(message_item.role);
 
   j["content"] = nlohmann::json::array();
   for (const auto &item : message_item.content) {
@@ -216,18 +153,8 @@ void to_json(nlohmann::json &j,
   j["id"] = func_call.id;
 
   if (func_call.status) {
-    if (*func_call.status == OpenResponsesFunctionToolCall::Status::Completed) {
-      j["status"] = "completed";
-    } else if (*func_call.status ==
-               OpenResponsesFunctionToolCall::Status::Incomplete) {
-      j["status"] = "incomplete";
-    } else if (*func_call.status ==
-               OpenResponsesFunctionToolCall::Status::InProgress) {
-      j["status"] = "in_progress";
-    } else {
-      throw std::runtime_error(
-          "Unknown OpenResponsesFunctionToolCall status enum value");
-    }
+    j["status"] = item_statuses<OpenResponsesFunctionToolCall::Status>.name(
+        *func_call.status);
   }
 }
 
@@ -243,25 +170,15 @@ void to_json(nlohmann::json &j,
   }
 
   if (func_call_output.status) {
-    if (*func_call_output.status ==
-        OpenResponsesFunctionCallOutput::Status::Completed) {
-      j["status"] = "completed";
-    } else if (*func_call_output.status ==
-               OpenResponsesFunctionCallOutput::Status::Incomplete) {
-      j["status"] = "incomplete";
-    } else if (*func_call_output.status ==
-               OpenResponsesFunctionCallOutput::Status::InProgress) {
-      j["status"] = "in_progress";
-    } else {
-      throw std::runtime_error(
-          "Unknown OpenResponsesFunctionCallOutput status enum value");
-    }
+    j["status"] =
+        item_statuses<OpenResponsesFunctionCallOutput::Status>.name(
+            *func_call_output.status);
   }
 }
 
 void to_json(nlohmann::json &j, const ResponseOutputText &text) {
   j = nlohmann::json::object();
-  j["type"] = "output_text";
+  j["type"] = output_content_types.name(OutputContentType::OutputText);
   j["text"] = text.text;
 
   if (text.annotations) {
@@ -271,18 +188,21 @@ void to_json(nlohmann::json &j, const ResponseOutputText &text) {
       std::visit([&ann_json](auto &&arg) {
         using T = std::decay_t<decltype(arg)>;
         if constexpr (std::is_same_v<T, ResponseOutputText::FileCitation>) {
-          ann_json["type"] = "file_citation";
+          ann_json["type"] =
+              annotation_types.name(AnnotationType::FileCitation);
           ann_json["file_id"] = arg.file_id;
           ann_json["filename"] = arg.filename;
           ann_json["index"] = arg.index;
         } else if constexpr (std::is_same_v<T, ResponseOutputText::URLCitation>) {
-          ann_json["type"] = "url_citation";
+          ann_json["type"] =
+              annotation_types.name(AnnotationType::URLCitation);
           ann_json["url"] = arg.url;
           ann_json["title"] = arg.title;
           ann_json["start_index"] = arg.start_index;
           ann_json["end_index"] = arg.end_index;
         } else if constexpr (std::is_same_v<T, ResponseOutputText::FilePath>) {
-          ann_json["type"] = "file_path";
+          ann_json["type"] =
+              annotation_types.name(AnnotationType::FilePath);
           ann_json["file_id"] = arg.file_id;
           ann_json["index"] = arg.index;
         } else {
@@ -297,36 +217,44 @@ void to_json(nlohmann::json &j, const ResponseOutputText &text) {
 void from_json(const nlohmann::json &j, ResponseOutputText &text) {
   text.text = j["text"].get<std::string>();
 
+  if (!j.contains("annotations") || j["annotations"].is_null()) {
+    return;
+  }
+
+  text.annotations = std::vector<ResponseOutputText::Annotation>();
   for (const auto &ann : j["annotations"]) {
-    std::string type = ann["type"].get<std::string>();
-    if (type == "file_citation") {
+    switch (annotation_types.parse(tag(ann["type"]))) {
+    case AnnotationType::FileCitation: {
       ResponseOutputText::FileCitation citation;
       citation.file_id = ann["file_id"].get<std::string>();
       citation.filename = ann["filename"].get<std::string>();
       citation.index = ann["index"].get<double>();
       text.annotations->push_back(citation);
-    } else if (type == "url_citation") {
+      break;
+    }
+    case AnnotationType::URLCitation: {
       ResponseOutputText::URLCitation citation;
       citation.url = ann["url"].get<std::string>();
       citation.title = ann["title"].get<std::string>();
       citation.start_index = ann["start_index"].get<double>();
       citation.end_index = ann["end_index"].get<double>();
       text.annotations->push_back(citation);
-    } else if (type == "file_path") {
+      break;
+    }
+    case AnnotationType::FilePath: {
       ResponseOutputText::FilePath file_path;
       file_path.file_id = ann["file_id"].get<std::string>();
       file_path.index = ann["index"].get<double>();
       text.annotations->push_back(file_path);
-    } else {
-      throw std::runtime_error(
-          std::format("Unknown ResponseOutputText Annotation type: {}", type));
+      break;
+    }
     }
   }
 }
 
 void to_json(nlohmann::json &j, const OpenAIResponsesRefusalContent &refusal) {
   j = nlohmann::json::object();
-  j["type"] = "refusal";
+  j["type"] = output_content_types.name(OutputContentType::Refusal);
   j["refusal"] = refusal.refusal;
 }
 
@@ -346,34 +274,32 @@ void to_json(nlohmann::json &j, const ResponsesOutputMessage &message) {
 
   j["id"] = message.id;
   j["role"] = "assistant";
-  j["type"] = "message";
+  j["type"] = output_item_types.name(OutputItemType::Message);
 
   if (message.status) {
-    if (*message.status == ResponsesOutputMessage::Status::Completed) {
-      j["status"] = "completed";
-    } else if (*message.status == ResponsesOutputMessage::Status::Incomplete) {
-      j["status"] = "incomplete";
-    } else if (*message.status == ResponsesOutputMessage::Status::InProgress) {
-      j["status"] = "in_progress";
-    } else {
-      throw std::runtime_error(
-          "Unknown ResponsesOutputMessage status enum value");
-    }
+    j["status"] =
+        item_statuses<ResponsesOutputMessage::Status>.name(*message.status);
   }
 }
 
 void from_json(const nlohmann::json &j, ResponsesOutputMessage &message) {
   for (const auto &item : j["content"]) {
-    std::string type = item["type"].get<std::string>();
-    if (type == "output_text") {
+    switch (output_content_types.parse(tag(item["type"]))) {
+    case OutputContentType::OutputText:
       message.content.push_back(item.get<ResponseOutputText>());
-    } else if (type == "refusal") {
+      break;
+    case OutputContentType::Refusal:
       message.content.push_back(item.get<OpenAIResponsesRefusalContent>());
-    } else {
-      throw std::runtime_error(
-          std::format("Unknown OutputMessageContent type: {}", type));
+      break;
     }
   }
+
+  message.id = j["id"].get<std::string>();
+
+  if (j.contains("status") && !j["status"].is_null()) {
+    message.status =
+        item_statuses<ResponsesOutputMessage::Status>.parse(tag(j["status"]));
+  }
 }
 
 void to_json(nlohmann::json &j, const ResponsesOutputItemReasoning &reasoning) {
@@ -388,7 +314,7 @@ void to_json(nlohmann::json &j, const ResponsesOutputItemReasoning &reasoning) {
     j["summary"].push_back(part);
   }
 
-  j["type"] = "reasoning";
+  j["type"] = output_item_types.name(OutputItemType::Reasoning);
 
   if (reasoning.content) {
     j["content"] = nlohmann::json::array();
@@ -405,18 +331,8 @@ void to_json(nlohmann::json &j, const ResponsesOutputItemReasoning &reasoning) {
   }
 
   if (reasoning.status) {
-    if (*reasoning.status == ResponsesOutputItemReasoning::Status::Completed) {
-      j["status"] = "completed";
-    } else if (*reasoning.status ==
-               ResponsesOutputItemReasoning::Status::Incomplete) {
-      j["status"] = "incomplete";
-    } else if (*reasoning.status ==
-               ResponsesOutputItemReasoning::Status::InProgress) {
-      j["status"] = "in_progress";
-    } else {
-      throw std::runtime_error(
-          "Unknown ResponsesOutputItemReasoning status enum value");
-    }
+    j["status"] = item_statuses<ResponsesOutputItemReasoning::Status>.name(
+        *reasoning.status);
   }
 }
 
@@ -440,17 +356,9 @@ void from_json(const nlohmann::json &j,
   }
 
   if (j.contains("status") && !j["status"].is_null()) {
-    std::string status = j["status"].get<std::string>();
-    if (status == "completed") {
-      reasoning.status = ResponsesOutputItemReasoning::Status::Completed;
-    } else if (status == "incomplete") {
-      reasoning.status = ResponsesOutputItemReasoning::Status::Incomplete;
-    } else if (status == "in_progress") {
-      reasoning.status = ResponsesOutputItemReasoning::Status::InProgress;
-    } else {
-      throw std::runtime_error(std::format(
-          "Unknown ResponsesOutputItemReasoning status: {}", status));
-    }
+    reasoning.status =
+        item_statuses<ResponsesOutputItemReasoning::Status>.parse(
+            tag(j["status"]));
   }
 }
 
@@ -460,25 +368,16 @@ void to_json(nlohmann::json &j,
   j["arguments"] = function_call.arguments;
   j["call_id"] = function_call.call_id;
   j["name"] = function_call.name;
-  j["type"] = "function_call";
+  j["type"] = output_item_types.name(OutputItemType::FunctionCall);
 
   if (function_call.id) {
     j["id"] = *function_call.id;
   }
 
   if (function_call.status) {
-    if (*function_call.status == ResponsesOutputItemFunctionCall::Status::Completed) {
-      j["status"] = "completed";
-    } else if (*function_call.status ==
-               ResponsesOutputItemFunctionCall::Status::Incomplete) {
-      j["status"] = "incomplete";
-    } else if (*function_call.status ==
-               ResponsesOutputItemFunctionCall::Status::InProgress) {
-      j["status"] = "in_progress";
-    } else {
-      throw std::runtime_error(
-          "Unknown ResponsesOutputItemFunctionCall status enum value");
-    }
+    j["status"] =
+        item_statuses<ResponsesOutputItemFunctionCall::Status>.name(
+            *function_call.status);
   }
 }
 
@@ -493,19 +392,9 @@ void from_json(const nlohmann::json &j,
   }
 
   if (!j["status"].is_null()) {
-    std::string status = j["status"].get<std::string>();
-    if (status == "completed") {
-      function_call.status = ResponsesOutputItemFunctionCall::Status::Completed;
-    } else if (status == "incomplete") {
-      function_call.status =
-          ResponsesOutputItemFunctionCall::Status::Incomplete;
-    } else if (status == "in_progress") {
-      function_call.status =
-          ResponsesOutputItemFunctionCall::Status::InProgress;
-    } else {
-      throw std::runtime_error(std::format(
-          "Unknown ResponsesOutputItemFunctionCall status: {}", status));
-    }
+    function_call.status =
+        item_statuses<ResponsesOutputItemFunctionCall::Status>.parse(
+            tag(j["status"]));
   }
 }
 
@@ -514,44 +403,19 @@ void to_json(nlohmann::json &j,
   j = nlohmann::json::object();
   j["id"] = web_search_call.id;
 
-  switch (web_search_call.status) {
-  case ResponsesWebSearchCallOutput::Status::Completed:
-    j["status"] = "completed";
-    break;
-  case ResponsesWebSearchCallOutput::Status::Searching:
-    j["status"] = "searching";
-    break;
-  case ResponsesWebSearchCallOutput::Status::InProgress:
-    j["status"] = "in_progress";
-    break;
-  case ResponsesWebSearchCallOutput::Status::Failed:
-    j["status"] = "failed";
-    break;
-  default:
-    throw std::runtime_error(
-        "Unknown ResponsesWebSearchCallOutput status enum value");
-  }
-
-  j["type"] = "web_search_call";
+  j["status"] = search_statuses<ResponsesWebSearchCallOutput::Status>.name(
+      web_search_call.status);
+
+  j["type"] = output_item_types.name(OutputItemType::WebSearchCall);
 }
 
 void from_json(const nlohmann::json &j,
                ResponsesWebSearchCallOutput &web_search_call) {
   web_search_call.id = j["id"].get<std::string>();
 
-  std::string status = j["status"].get<std::string>();
-  if (status == "completed") {
-    web_search_call.status = ResponsesWebSearchCallOutput::Status::Completed;
-  } else if (status == "searching") {
-    web_search_call.status = ResponsesWebSearchCallOutput::Status::Searching;
-  } else if (status == "in_progress") {
-    web_search_call.status = ResponsesWebSearchCallOutput::Status::InProgress;
-  } else if (status == "failed") {
-    web_search_call.status = ResponsesWebSearchCallOutput::Status::Failed;
-  } else {
-    throw std::runtime_error(
-        std::format("Unknown ResponsesWebSearchCallOutput status: {}", status));
-  }
+  web_search_call.status =
+      search_statuses<ResponsesWebSearchCallOutput::Status>.parse(
+          tag(j["status"]));
 }
 
 void to_json(nlohmann::json &j,
@@ -564,25 +428,11 @@ void to_json(nlohmann::json &j,
     j["queries"].push_back(query);
   }
 
-  switch (file_search_call.status) {
-  case ResponsesOutputItemFileSearchCall::Status::Completed:
-    j["status"] = "completed";
-    break;
-  case ResponsesOutputItemFileSearchCall::Status::Searching:
-    j["status"] = "searching";
-    break;
-  case ResponsesOutputItemFileSearchCall::Status::InProgress:
-    j["status"] = "in_progress";
-    break;
-  case ResponsesOutputItemFileSearchCall::Status::Failed:
-    j["status"] = "failed";
-    break;
-  default:
-    throw std::runtime_error(
-        "Unknown ResponsesOutputItemFileSearchCall status enum value");
-  }
-
-  j["type"] = "file_search_call";
+  j["status"] =
+      search_statuses<ResponsesOutputItemFileSearchCall::Status>.name(
+          file_search_call.status);
+
+  j["type"] = output_item_types.name(OutputItemType::FileSearchCall);
 }
 
 void from_json(const nlohmann::json &j,
@@ -593,46 +443,19 @@ void from_json(const nlohmann::json &j,
     file_search_call.queries.push_back(query.get<std::string>());
   }
 
-  std::string status = j["status"].get<std::string>();
-  if (status == "completed") {
-    file_search_call.status =
-        ResponsesOutputItemFileSearchCall::Status::Completed;
-  } else if (status == "searching") {
-    file_search_call.status =
-        ResponsesOutputItemFileSearchCall::Status::Searching;
-  } else if (status == "in_progress") {
-    file_search_call.status =
-        ResponsesOutputItemFileSearchCall::Status::InProgress;
-  } else if (status == "failed") {
-    file_search_call.status = ResponsesOutputItemFileSearchCall::Status::Failed;
-  } else {
-    throw std::runtime_error(std::format(
-        "Unknown ResponsesOutputItemFileSearchCall status: {}", status));
-  }
+  file_search_call.status =
+      search_statuses<ResponsesOutputItemFileSearchCall::Status>.parse(
+          tag(j["status"]));
 }
 
 void to_json(nlohmann::json &j,
              const ResponsesImageGenerationCall &image_generation_call) {
   j = nlohmann::json::object();
   j["id"] = image_generation_call.id;
+  j["type"] = output_item_types.name(OutputItemType::ImageGenerationCall);
 
-  switch (image_generation_call.status) {
-  case ResponsesImageGenerationCall::Status::InProgress:
-    j["status"] = "in_progress";
-    break;
-  case ResponsesImageGenerationCall::Status::Completed:
-    j["status"] = "completed";
-    break;
-  case ResponsesImageGenerationCall::Status::Generating:
-    j["status"] = "generating";
-    break;
-  case ResponsesImageGenerationCall::Status::Failed:
-    j["status"] = "failed";
-    break;
-  default:
-    throw std::runtime_error(
-        "Unknown ResponsesImageGenerationCall status enum value");
-  }
+  j["status"] =
+      image_generation_statuses.name(image_generation_call.status);
 
   if (image_generation_call.result) {
     j["result"] = *image_generation_call.result;
@@ -643,22 +466,8 @@ void from_json(const nlohmann::json &j,
                ResponsesImageGenerationCall &image_generation_call) {
   image_generation_call.id = j["id"].get<std::string>();
 
-  std::string status = j["status"].get<std::string>();
-  if (status == "in_progress") {
-    image_generation_call.status =
-        ResponsesImageGenerationCall::Status::InProgress;
-  } else if (status == "completed") {
-    image_generation_call.status =
-        ResponsesImageGenerationCall::Status::Completed;
-  } else if (status == "generating") {
-    image_generation_call.status =
-        ResponsesImageGenerationCall::Status::Generating;
-  } else if (status == "failed") {
-    image_generation_call.status = ResponsesImageGenerationCall::Status::Failed;
-  } else {
-    throw std::runtime_error(
-        std::format("Unknown ResponsesImageGenerationCall status: {}", status));
-  }
+  image_generation_call.status =
+      image_generation_statuses.parse(tag(j["status"]));
 
   if (!j["result"].is_null()) {
     image_generation_call.result = j["result"].get<std::string>();
@@ -672,13 +481,46 @@ void to_json(nlohmann::json &j, const OpenResponsesInput &input) {
 void to_json(nlohmann::json &j, const Request &req) {
   j = nlohmann::json::object();
 
-  if (req.input) {
+  if (req.prefix || req.conversation) {
+    j["input"] = nlohmann::json::array();
+    if (req.prefix) {
+      for (const auto &item : req.prefix->input()) {
+        j["input"].push_back(item);
+      }
+    }
+    if (req.conversation) {
+      for (const auto &item : req.conversation->input()) {
+        j["input"].push_back(item);
+      }
+    }
+    if (req.input) {
+      if (auto text = std::get_if<std::string>(&*req.input)) {
+        j["input"].push_back(OpenResponsesEasyInputMessage{
+            OpenResponsesEasyInputMessage::User, {InputText{*text}}});
+      } else {
+        for (const auto &item :
+             std::get<std::vector<OpenResponsesInput>>(*req.input)) {
+          j["input"].push_back(item);
+        }
+      }
+    }
+  } else if (req.input) {
     std::visit([&j](auto &&arg) { j["input"] = arg; }, *req.input);
   }
 
-  if (req.model) {
+  if (req.prefix && req.prefix->model()) {
+    if (req.model) {
+      throw std::runtime_error(
+          "Request::model conflicts with the model of its prefix");
+    }
+    j["model"] = *req.prefix->model();
+  } else if (req.model) {
     j["model"] = *req.model;
   }
+
+  if (req.stream) {
+    j["stream"] = *req.stream;
+  }
 }
 
 void from_json(const nlohmann::json &j, Response &resp) {
@@ -689,22 +531,25 @@ void from_json(const nlohmann::json &j, Response &resp) {
         ResponsesOutputItemFileSearchCall, ResponsesImageGenerationCall>>();
 
     for (const auto &item : j["output"]) {
-      std::string type = item["type"].get<std::string>();
-      if (type == "message") {
+      switch (output_item_types.parse(tag(item["type"]))) {
+      case OutputItemType::Message:
         resp.output->push_back(item.get<ResponsesOutputMessage>());
-      } else if (type == "reasoning") {
+        break;
+      case OutputItemType::Reasoning:
         resp.output->push_back(item.get<ResponsesOutputItemReasoning>());
-      } else if (type == "function_call") {
+        break;
+      case OutputItemType::FunctionCall:
         resp.output->push_back(item.get<ResponsesOutputItemFunctionCall>());
-      } else if (type == "web_search_call") {
+        break;
+      case OutputItemType::WebSearchCall:
         resp.output->push_back(item.get<ResponsesWebSearchCallOutput>());
-      } else if (type == "file_search_call") {
+        break;
+      case OutputItemType::FileSearchCall:
         resp.output->push_back(item.get<ResponsesOutputItemFileSearchCall>());
-      } else if (type == "image_generation_call") {
+        break;
+      case OutputItemType::ImageGenerationCall:
         resp.output->push_back(item.get<ResponsesImageGenerationCall>());
-      } else {
-        throw std::runtime_error(
-            std::format("Unknown OutputItem type: {}", type));
+        break;
       }
     }
   }
@@ -0,0 +1,116 @@
+#include "retrier.hpp"
+#include "openrouter/error.hpp"
+#include <algorithm>
+#include <random>
+
+namespace openrouter {
+
+// Other 5xx answers, such as 501 and 505, are permanent.
+static bool retryable(long status) {
+  switch (status) {
+  case 408:
+  case 425:
+  case 429:
+  case 500:
+  case 502:
+  case 503:
+  case 504:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool retryable(CURLcode code) {
+  switch (code) {
+  case CURLE_COULDNT_RESOLVE_HOST:
+  case CURLE_COULDNT_CONNECT:
+  case CURLE_OPERATION_TIMEDOUT:
+  case CURLE_SEND_ERROR:
+  case CURLE_RECV_ERROR:
+  case CURLE_GOT_NOTHING:
+  case CURLE_PARTIAL_FILE:
+  case CURLE_HTTP2:
+  case CURLE_HTTP2_STREAM:
+  case CURLE_SSL_CONNECT_ERROR:
+    return true;
+  default:
+    return false;
+  }
+}
+
+Retrier::Retrier(const RetryPolicy &policy)
+    : policy(policy), tokens(std::min(policy.budget_min_per_second,
+                                      policy.budget_max_tokens)),
+      refilled(std::chrono::steady_clock::now()) {}
+
+void Retrier::record_request() {
+  std::lock_guard lock(mutex);
+  tokens = std::min(policy.budget_max_tokens, tokens + policy.budget_ratio);
+}
+
+bool Retrier::spend() {
+  std::lock_guard lock(mutex);
+  auto now = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed = now - refilled;
+  refilled = now;
+  // Only traffic banks retries: the floor tops the budget up to one second
+  // of itself, so a quiet spell does not fund a burst of them.
+  double floor = std::min(policy.budget_min_per_second,
+                          policy.budget_max_tokens);
+  if (tokens < floor) {
+    tokens = std::min(floor,
+                      tokens + elapsed.count() * policy.budget_min_per_second);
+  }
+
+  if (tokens < 1) {
+    return false;
+  }
+  tokens -= 1;
+  return true;
+}
+
+// Full jitter: uniform in [0, min(max_delay, base_delay * 2^(attempt - 1))].
+std::chrono::milliseconds Retrier::backoff(int attempt) const {
+  thread_local std::minstd_rand random(std::random_device{}());
+
+  auto ceiling = policy.base_delay * (1LL << std::min(attempt - 1, 20));
+  ceiling = std::min<std::chrono::milliseconds>(ceiling, policy.max_delay);
+  std::uniform_int_distribution<long long> jitter(0, ceiling.count());
+  return std::chrono::milliseconds(jitter(random));
+}
+
+std::optional<std::chrono::milliseconds>
+Retrier::next_delay(int attempt, std::exception_ptr error) {
+  if (attempt >= policy.max_attempts) {
+    return std::nullopt;
+  }
+
+  std::optional<std::chrono::milliseconds> hint;
+  try {
+    std::rethrow_exception(error);
+  } catch (const HttpError &e) {
+    if (!retryable(e.status())) {
+      return std::nullopt;
+    }
+    hint = e.retry_after();
+  } catch (const TransportError &e) {
+    if (!retryable(e.code())) {
+      return std::nullopt;
+    }
+  } catch (...) {
+    return std::nullopt;
+  }
+
+  if (hint && *hint > policy.max_retry_after) {
+    return std::nullopt;
+  }
+  if (!spend()) {
+    return std::nullopt;
+  }
+  // Jitter on top of a hint too, or every client throttled by the same
+  // answer would come back at the same moment.
+  return hint ? *hint + backoff(attempt) : backoff(attempt);
+}
+
+} // namespace openrouter
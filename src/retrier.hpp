@@ -0,0 +1,34 @@
+#pragma once
+#include "openrouter/retry.hpp"
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <optional>
+
+namespace openrouter {
+
+// Decides whether and when a failed attempt is retried. Shared by every
+// call on a client, so the retry budget is global to it.
+class Retrier {
+public:
+  explicit Retrier(const RetryPolicy &policy);
+
+  // Counts a first attempt towards the retry budget.
+  void record_request();
+
+  // Delay before attempt `attempt + 1`, or nullopt when `error` should be
+  // surfaced. Spends budget when it returns a delay.
+  std::optional<std::chrono::milliseconds> next_delay(int attempt,
+                                                      std::exception_ptr error);
+
+private:
+  std::chrono::milliseconds backoff(int attempt) const;
+  bool spend();
+
+  RetryPolicy policy;
+  std::mutex mutex;
+  double tokens;
+  std::chrono::steady_clock::time_point refilled;
+};
+
+} // namespace openrouter
@@ -0,0 +1,502 @@
+#include "openrouter/serializer.hpp"
+#include "json_writer.hpp"
+#include "tags.hpp"
+#include <stdexcept>
+
+namespace openrouter {
+
+template <typename Status> static std::string_view item_status(Status status) {
+  return item_statuses<Status>.name(status);
+}
+
+template <typename Status>
+static std::string_view search_status(Status status) {
+  return search_statuses<Status>.name(status);
+}
+
+static void write_text_parts(JsonWriter &w, std::string_view type,
+                             const std::vector<std::string> &parts) {
+  w.begin_array();
+  for (const auto &part : parts) {
+    w.begin_object();
+    w.key("type");
+    w.value(type);
+    w.key("text");
+    w.value(part);
+    w.end_object();
+  }
+  w.end_array();
+}
+
+void write(JsonWriter &w, const InputText &text) {
+  w.begin_object();
+  w.key("type");
+  w.value("input_text");
+  w.key("text");
+  w.value(text.text);
+  w.end_object();
+}
+
+void write(JsonWriter &w, const InputImage &image) {
+  w.begin_object();
+  w.key("type");
+  w.value("input_image");
+
+  w.key("detail");
+  w.value(image_details.name(image.detail));
+
+  if (image.attachment) {
+    w.key("image_url");
+    w.attachment(*image.attachment, true);
+  } else if (image.url) {
+    w.key("image_url");
+    w.value(*image.url);
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w, const InputFile &file) {
+  w.begin_object();
+  w.key("type");
+  w.value("input_file");
+
+  if (file.id) {
+    w.key("file_id");
+    w.value(*file.id);
+  }
+  if (file.attachment) {
+    w.key("file_data");
+    w.attachment(*file.attachment, true);
+  } else if (file.data) {
+    w.key("file_data");
+    w.value(*file.data);
+  }
+  if (file.filename) {
+    w.key("filename");
+    w.value(*file.filename);
+  }
+  if (file.url) {
+    w.key("file_url");
+    w.value(*file.url);
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w, const InputAudio &audio) {
+  w.begin_object();
+  w.key("type");
+  w.value("input_audio");
+
+  w.key("input_audio");
+  w.begin_object();
+  w.key("data");
+  if (audio.attachment) {
+    w.attachment(*audio.attachment, false);
+  } else {
+    w.value(audio.data);
+  }
+  w.key("format");
+  w.value(audio_formats.name(audio.format));
+  w.end_object();
+
+  w.end_object();
+}
+
+void write(JsonWriter &w, const OpenResponsesEasyInputMessageContent &content) {
+  std::visit([&w](auto &&arg) { write(w, arg); }, content);
+}
+
+void write(JsonWriter &w, const OpenResponsesReasoning &reasoning) {
+  w.begin_object();
+  w.key("type");
+  w.value("reasoning");
+  w.key("id");
+  w.value(reasoning.id);
+  w.key("summary");
+  write_text_parts(w, "summary_text", reasoning.summary);
+
+  if (reasoning.content) {
+    w.key("content");
+    write_text_parts(w, "reasoning_text", *reasoning.content);
+  }
+
+  if (reasoning.encrypted_content) {
+    w.key("encrypted_content");
+    w.value(*reasoning.encrypted_content);
+  }
+
+  if (reasoning.format) {
+    w.key("format");
+    w.value(reasoning_formats.name(*reasoning.format));
+  }
+
+  if (reasoning.signature) {
+    w.key("signature");
+    w.value(*reasoning.signature);
+  }
+
+  if (reasoning.status) {
+    w.key("status");
+    w.value(item_status(*reasoning.status));
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w, const OpenResponsesEasyInputMessage &message) {
+  w.begin_object();
+  w.key("type");
+  w.value("message");
+
+  w.key("role");
+  w.value(easy_input_roles.name(message.role));
+
+  w.key("content");
+  w.begin_array();
+  for (const auto &item : message.content) {
+    std::visit(
+        [&w](auto &&arg) {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, std::string>) {
+            w.value(arg);
+          } else {
+            write(w, arg);
+          }
+        },
+        item);
+  }
+  w.end_array();
+  w.end_object();
+}
+
+void write(JsonWriter &w, const OpenResponsesInputMessageItem &message_item) {
+  w.begin_object();
+  w.key("type");
+  w.value("message");
+
+  w.key("role");
+  w.value(input_item_roles.name(message_item.role));
+
+  w.key("content");
+  w.begin_array();
+  for (const auto &item : message_item.content) {
+    write(w, item);
+  }
+  w.end_array();
+
+  if (message_item.id) {
+    w.key("id");
+    w.value(*message_item.id);
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w, const OpenResponsesFunctionToolCall &func_call) {
+  w.begin_object();
+  w.key("type");
+  w.value("function_call");
+  w.key("call_id");
+  w.value(func_call.call_id);
+  w.key("name");
+  w.value(func_call.name);
+  w.key("arguments");
+  w.value(func_call.arguments);
+  w.key("id");
+  w.value(func_call.id);
+
+  if (func_call.status) {
+    w.key("status");
+    w.value(item_status(*func_call.status));
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w,
+           const OpenResponsesFunctionCallOutput &func_call_output) {
+  w.begin_object();
+  w.key("type");
+  w.value("function_call_output");
+  w.key("call_id");
+  w.value(func_call_output.call_id);
+  w.key("output");
+  w.value(func_call_output.output);
+
+  if (func_call_output.id) {
+    w.key("id");
+    w.value(*func_call_output.id);
+  }
+
+  if (func_call_output.status) {
+    w.key("status");
+    w.value(item_status(*func_call_output.status));
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w, const ResponseOutputText &text) {
+  w.begin_object();
+  w.key("type");
+  w.value(output_content_types.name(OutputContentType::OutputText));
+  w.key("text");
+  w.value(text.text);
+
+  if (text.annotations) {
+    w.key("annotations");
+    w.begin_array();
+    for (const auto &ann : *text.annotations) {
+      w.begin_object();
+      std::visit(
+          [&w](auto &&arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, ResponseOutputText::FileCitation>) {
+              w.key("type");
+              w.value(annotation_types.name(AnnotationType::FileCitation));
+              w.key("file_id");
+              w.value(arg.file_id);
+              w.key("filename");
+              w.value(arg.filename);
+              w.key("index");
+              w.value(arg.index);
+            } else if constexpr (std::is_same_v<
+                                     T, ResponseOutputText::URLCitation>) {
+              w.key("type");
+              w.value(annotation_types.name(AnnotationType::URLCitation));
+              w.key("url");
+              w.value(arg.url);
+              w.key("title");
+              w.value(arg.title);
+              w.key("start_index");
+              w.value(arg.start_index);
+              w.key("end_index");
+              w.value(arg.end_index);
+            } else if constexpr (std::is_same_v<T,
+                                                ResponseOutputText::FilePath>) {
+              w.key("type");
+              w.value(annotation_types.name(AnnotationType::FilePath));
+              w.key("file_id");
+              w.value(arg.file_id);
+              w.key("index");
+              w.value(arg.index);
+            }
+          },
+          ann);
+      w.end_object();
+    }
+    w.end_array();
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w, const OpenAIResponsesRefusalContent &refusal) {
+  w.begin_object();
+  w.key("type");
+  w.value(output_content_types.name(OutputContentType::Refusal));
+  w.key("refusal");
+  w.value(refusal.refusal);
+  w.end_object();
+}
+
+void write(JsonWriter &w, const ResponsesOutputMessage &message) {
+  w.begin_object();
+  w.key("type");
+  w.value(output_item_types.name(OutputItemType::Message));
+  w.key("role");
+  w.value("assistant");
+  w.key("id");
+  w.value(message.id);
+
+  w.key("content");
+  w.begin_array();
+  for (const auto &item : message.content) {
+    std::visit([&w](auto &&arg) { write(w, arg); }, item);
+  }
+  w.end_array();
+
+  if (message.status) {
+    w.key("status");
+    w.value(item_status(*message.status));
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w, const ResponsesOutputItemReasoning &reasoning) {
+  w.begin_object();
+  w.key("type");
+  w.value(output_item_types.name(OutputItemType::Reasoning));
+  w.key("id");
+  w.value(reasoning.id);
+  w.key("summary");
+  write_text_parts(w, "summary_text", reasoning.summary);
+
+  if (reasoning.content) {
+    w.key("content");
+    write_text_parts(w, "reasoning_text", *reasoning.content);
+  }
+
+  if (reasoning.encrypted_content) {
+    w.key("encrypted_content");
+    w.value(*reasoning.encrypted_content);
+  }
+
+  if (reasoning.status) {
+    w.key("status");
+    w.value(item_status(*reasoning.status));
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w,
+           const ResponsesOutputItemFunctionCall &function_call) {
+  w.begin_object();
+  w.key("type");
+  w.value(output_item_types.name(OutputItemType::FunctionCall));
+  w.key("arguments");
+  w.value(function_call.arguments);
+  w.key("call_id");
+  w.value(function_call.call_id);
+  w.key("name");
+  w.value(function_call.name);
+
+  if (function_call.id) {
+    w.key("id");
+    w.value(*function_call.id);
+  }
+
+  if (function_call.status) {
+    w.key("status");
+    w.value(item_status(*function_call.status));
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w, const ResponsesWebSearchCallOutput &web_search_call) {
+  w.begin_object();
+  w.key("type");
+  w.value(output_item_types.name(OutputItemType::WebSearchCall));
+  w.key("id");
+  w.value(web_search_call.id);
+  w.key("status");
+  w.value(search_status(web_search_call.status));
+  w.end_object();
+}
+
+void write(JsonWriter &w,
+           const ResponsesOutputItemFileSearchCall &file_search_call) {
+  w.begin_object();
+  w.key("type");
+  w.value(output_item_types.name(OutputItemType::FileSearchCall));
+  w.key("id");
+  w.value(file_search_call.id);
+
+  w.key("queries");
+  w.begin_array();
+  for (const auto &query : file_search_call.queries) {
+    w.value(query);
+  }
+  w.end_array();
+
+  w.key("status");
+  w.value(search_status(file_search_call.status));
+  w.end_object();
+}
+
+void write(JsonWriter &w,
+           const ResponsesImageGenerationCall &image_generation_call) {
+  w.begin_object();
+  w.key("type");
+  w.value(output_item_types.name(OutputItemType::ImageGenerationCall));
+  w.key("id");
+  w.value(image_generation_call.id);
+
+  w.key("status");
+  w.value(image_generation_statuses.name(image_generation_call.status));
+
+  if (image_generation_call.result) {
+    w.key("result");
+    w.value(*image_generation_call.result);
+  }
+  w.end_object();
+}
+
+void write(JsonWriter &w, const OpenResponsesInput &input) {
+  std::visit([&w](auto &&arg) { write(w, arg); }, input);
+}
+
+static void write_user_text(JsonWriter &w, const std::string &text) {
+  write(w, OpenResponsesEasyInputMessage{OpenResponsesEasyInputMessage::User,
+                                         {InputText{text}}});
+}
+
+void write(JsonWriter &w, const Request &req, std::optional<bool> stream) {
+  const RequestPrefix *prefix = req.prefix ? &*req.prefix : nullptr;
+  w.begin_object();
+
+  if (prefix && !prefix->members_json().empty()) {
+    w.raw(prefix->members_json());
+  }
+
+  if (req.model) {
+    if (prefix && prefix->model()) {
+      throw std::runtime_error(
+          "Request::model conflicts with the model of its prefix");
+    }
+    w.key("model");
+    w.value(*req.model);
+  }
+
+  if (auto value = stream ? stream : req.stream) {
+    w.key("stream");
+    w.value(*value);
+  }
+
+  if (prefix || req.conversation) {
+    w.key("input");
+    w.begin_array();
+    if (prefix && !prefix->items_body().empty()) {
+      w.raw(prefix->items_body());
+    }
+    if (req.conversation && !req.conversation->items_body().empty()) {
+      w.raw(req.conversation->items_body());
+    }
+    if (req.input) {
+      if (auto text = std::get_if<std::string>(&*req.input)) {
+        write_user_text(w, *text);
+      } else {
+        for (const auto &item :
+             std::get<std::vector<OpenResponsesInput>>(*req.input)) {
+          write(w, item);
+        }
+      }
+    }
+    w.end_array();
+  } else if (req.input) {
+    w.key("input");
+    std::visit(
+        [&w](auto &&arg) {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, std::string>) {
+            w.value(arg);
+          } else {
+            w.begin_array();
+            for (const auto &item : arg) {
+              write(w, item);
+            }
+            w.end_array();
+          }
+        },
+        *req.input);
+  }
+
+  w.end_object();
+}
+
+void serialize(const Request &request, std::string &out) {
+  JsonWriter w(out);
+  write(w, request);
+}
+
+void serialize(const OpenResponsesInput &input, std::string &out) {
+  JsonWriter w(out);
+  write(w, input);
+}
+
+} // namespace openrouter
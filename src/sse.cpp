@@ -0,0 +1,93 @@
+#include "sse.hpp"
+#include <utility>
+
+namespace openrouter {
+
+SSEParser::SSEParser(Callback callback) : callback(std::move(callback)) {}
+
+void SSEParser::feed(std::string_view chunk) {
+  // A CR that ended the previous chunk may be the first half of a CRLF.
+  if (skip_lf && !chunk.empty()) {
+    if (chunk.front() == '\n') {
+      chunk.remove_prefix(1);
+    }
+    skip_lf = false;
+  }
+
+  while (!chunk.empty()) {
+    auto eol = chunk.find_first_of("\r\n");
+    if (eol == std::string_view::npos) {
+      line_buffer.append(chunk);
+      return;
+    }
+
+    std::string_view line = chunk.substr(0, eol);
+    if (chunk[eol] == '\r') {
+      if (eol + 1 == chunk.size()) {
+        skip_lf = true;
+      } else if (chunk[eol + 1] == '\n') {
+        ++eol;
+      }
+    }
+    chunk.remove_prefix(eol + 1);
+
+    if (line_buffer.empty()) {
+      process_line(line);
+    } else {
+      line_buffer.append(line);
+      process_line(line_buffer);
+      line_buffer.clear();
+    }
+  }
+}
+
+void SSEParser::finish() {
+  line_buffer.clear();
+  event.type.clear();
+  event.data.clear();
+  has_data = false;
+  skip_lf = false;
+}
+
+void SSEParser::process_line(std::string_view line) {
+  if (line.empty()) {
+    dispatch();
+    return;
+  }
+
+  if (line.front() == ':') {
+    return;
+  }
+
+  std::string_view field = line;
+  std::string_view value;
+  if (auto colon = line.find(':'); colon != std::string_view::npos) {
+    field = line.substr(0, colon);
+    value = line.substr(colon + 1);
+    if (!value.empty() && value.front() == ' ') {
+      value.remove_prefix(1);
+    }
+  }
+
+  if (field == "event") {
+    event.type = value;
+  } else if (field == "data") {
+    if (has_data) {
+      event.data.push_back('\n');
+    }
+    event.data.append(value);
+    has_data = true;
+  }
+}
+
+void SSEParser::dispatch() {
+  if (has_data) {
+    callback(event);
+  }
+
+  event.type.clear();
+  event.data.clear();
+  has_data = false;
+}
+
+} // namespace openrouter
@@ -0,0 +1,35 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace openrouter {
+
+class SSEParser {
+public:
+  struct Event {
+    std::string type;
+    std::string data;
+  };
+
+  using Callback = std::function<void(const Event &)>;
+
+  explicit SSEParser(Callback callback);
+
+  void feed(std::string_view chunk);
+  // Ends the stream. An event still missing its blank line was cut short,
+  // and is discarded rather than dispatched.
+  void finish();
+
+private:
+  void process_line(std::string_view line);
+  void dispatch();
+
+  Callback callback;
+  std::string line_buffer;
+  Event event;
+  bool has_data = false;
+  bool skip_lf = false;
+};
+
+} // namespace openrouter
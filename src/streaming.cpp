@@ -0,0 +1,39 @@
+#include "openrouter/streaming.hpp"
+#include "nlohmann/json.hpp"
+
+namespace openrouter {
+
+void from_json(const nlohmann::json &j, ResponseOutputTextDelta &event) {
+  event.item_id = j.value("item_id", "");
+  event.output_index = j.value("output_index", 0);
+  event.content_index = j.value("content_index", 0);
+  event.delta = j["delta"].get<std::string>();
+}
+
+void from_json(const nlohmann::json &j,
+               ResponseFunctionCallArgumentsDelta &event) {
+  event.item_id = j.value("item_id", "");
+  event.output_index = j.value("output_index", 0);
+  event.delta = j["delta"].get<std::string>();
+}
+
+void from_json(const nlohmann::json &j, ResponseReasoningTextDelta &event) {
+  event.item_id = j.value("item_id", "");
+  event.output_index = j.value("output_index", 0);
+  event.content_index = j.value("content_index", 0);
+  event.delta = j["delta"].get<std::string>();
+}
+
+void from_json(const nlohmann::json &j,
+               ResponseReasoningSummaryTextDelta &event) {
+  event.item_id = j.value("item_id", "");
+  event.output_index = j.value("output_index", 0);
+  event.summary_index = j.value("summary_index", 0);
+  event.delta = j["delta"].get<std::string>();
+}
+
+void from_json(const nlohmann::json &j, ResponseCompleted &event) {
+  event.response = j["response"].get<Response>();
+}
+
+} // namespace openrouter
@@ -0,0 +1,255 @@
+#pragma once
+#include "openrouter/responses.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+namespace openrouter {
+
+template <typename Enum> struct TagEntry {
+  std::string_view name;
+  Enum value;
+};
+
+// Two-way mapping between an enum and its wire names, built at compile time.
+// Names are found through a perfect hash of their length and first, middle
+// and last bytes, so a lookup is a multiply and one comparison; a table with
+// no such hash fails to compile. Values must be 0 to N - 1.
+template <typename Enum, std::size_t N> class TagTable {
+public:
+  consteval TagTable(std::string_view what,
+                     const TagEntry<Enum> (&entries)[N])
+      : what(what) {
+    for (const auto &entry : entries) {
+      auto value = static_cast<std::size_t>(entry.value);
+      if (value >= N || !names[value].empty()) {
+        throw "TagTable values must be distinct and below N";
+      }
+      names[value] = entry.name;
+    }
+
+    for (;; seed += 2) {
+      slots = {};
+      bool perfect = true;
+      for (const auto &entry : entries) {
+        auto &slot = slots[this->slot(entry.name)];
+        perfect = perfect && slot == 0;
+        slot = static_cast<std::uint8_t>(
+            static_cast<std::size_t>(entry.value) + 1);
+      }
+      if (perfect) {
+        break;
+      }
+      if (seed > (1u << 20)) {
+        throw "No perfect hash for TagTable names";
+      }
+    }
+  }
+
+  std::optional<Enum> find(std::string_view name) const {
+    std::uint8_t slot = slots[this->slot(name)];
+    if (slot == 0 || names[slot - 1] != name) {
+      return std::nullopt;
+    }
+    return static_cast<Enum>(slot - 1);
+  }
+
+  Enum parse(std::string_view name) const {
+    if (auto value = find(name)) {
+      return *value;
+    }
+    throw std::runtime_error(std::format("Unknown {}: {}", what, name));
+  }
+
+  std::string_view name(Enum value) const {
+    auto index = static_cast<std::size_t>(value);
+    if (index >= N) {
+      throw std::runtime_error(std::format("Unknown {} enum value", what));
+    }
+    return names[index];
+  }
+
+private:
+  static constexpr int bits = std::bit_width(2 * N - 1);
+
+  static constexpr std::uint32_t key(std::string_view name) {
+    if (name.empty()) {
+      return 0;
+    }
+    auto byte = [name](std::size_t i) {
+      return static_cast<std::uint32_t>(static_cast<unsigned char>(name[i]));
+    };
+    return static_cast<std::uint32_t>(name.size()) ^ byte(0) << 8 ^
+           byte(name.size() / 2) << 16 ^ byte(name.size() - 1) << 24;
+  }
+
+  constexpr std::size_t slot(std::string_view name) const {
+    return static_cast<std::uint32_t>(key(name) * seed) >> (32 - bits);
+  }
+
+  std::string_view what;
+  std::array<std::string_view, N> names{};
+  // Value + 1 of the entry hashed to each slot, 0 for none.
+  std::array<std::uint8_t, std::size_t(1) << bits> slots{};
+  std::uint32_t seed = 1;
+};
+
+template <typename Enum, std::size_t N>
+consteval TagTable<Enum, N> tags(std::string_view what,
+                                 const TagEntry<Enum> (&entries)[N]) {
+  return TagTable<Enum, N>(what, entries);
+}
+
+// Alternatives of the output item, annotation and message content variants,
+// in variant order.
+enum class OutputItemType {
+  Message,
+  Reasoning,
+  FunctionCall,
+  WebSearchCall,
+  FileSearchCall,
+  ImageGenerationCall,
+};
+
+enum class AnnotationType {
+  FileCitation,
+  URLCitation,
+  FilePath,
+};
+
+enum class OutputContentType {
+  OutputText,
+  Refusal,
+};
+
+// The stream events the client acts on; others are skipped.
+enum class StreamEventType {
+  OutputTextDelta,
+  FunctionCallArgumentsDelta,
+  ReasoningTextDelta,
+  ReasoningSummaryTextDelta,
+  Completed,
+  Failed,
+  Error,
+};
+
+inline constexpr auto output_item_types = tags<OutputItemType>(
+    "OutputItem type",
+    {
+        {"message", OutputItemType::Message},
+        {"reasoning", OutputItemType::Reasoning},
+        {"function_call", OutputItemType::FunctionCall},
+        {"web_search_call", OutputItemType::WebSearchCall},
+        {"file_search_call", OutputItemType::FileSearchCall},
+        {"image_generation_call", OutputItemType::ImageGenerationCall},
+    });
+
+inline constexpr auto annotation_types = tags<AnnotationType>(
+    "ResponseOutputText Annotation type",
+    {
+        {"file_citation", AnnotationType::FileCitation},
+        {"url_citation", AnnotationType::URLCitation},
+        {"file_path", AnnotationType::FilePath},
+    });
+
+inline constexpr auto output_content_types = tags<OutputContentType>(
+    "OutputMessageContent type",
+    {
+        {"output_text", OutputContentType::OutputText},
+        {"refusal", OutputContentType::Refusal},
+    });
+
+inline constexpr auto stream_event_types = tags<StreamEventType>(
+    "stream event type",
+    {
+        {"response.output_text.delta", StreamEventType::OutputTextDelta},
+        {"response.function_call_arguments.delta",
+         StreamEventType::FunctionCallArgumentsDelta},
+        {"response.reasoning_text.delta", StreamEventType::ReasoningTextDelta},
+        {"response.reasoning_summary_text.delta",
+         StreamEventType::ReasoningSummaryTextDelta},
+        {"response.completed", StreamEventType::Completed},
+        {"response.failed", StreamEventType::Failed},
+        {"error", StreamEventType::Error},
+    });
+
+// Shared by every item whose status is Completed, Incomplete or InProgress.
+template <typename Status>
+inline constexpr auto item_statuses = tags<Status>(
+    "item status",
+    {
+        {"completed", Status::Completed},
+        {"incomplete", Status::Incomplete},
+        {"in_progress", Status::InProgress},
+    });
+
+template <typename Status>
+inline constexpr auto search_statuses = tags<Status>(
+    "search call status",
+    {
+        {"completed", Status::Completed},
+        {"searching", Status::Searching},
+        {"in_progress", Status::InProgress},
+        {"failed", Status::Failed},
+    });
+
+inline constexpr auto image_generation_statuses =
+    tags<ResponsesImageGenerationCall::Status>(
+        "ResponsesImageGenerationCall status",
+        {
+            {"in_progress", ResponsesImageGenerationCall::InProgress},
+            {"completed", ResponsesImageGenerationCall::Completed},
+            {"generating", ResponsesImageGenerationCall::Generating},
+            {"failed", ResponsesImageGenerationCall::Failed},
+        });
+
+inline constexpr auto image_details = tags<InputImage::Detail>(
+    "InputImage detail",
+    {
+        {"auto", InputImage::Auto},
+        {"high", InputImage::High},
+        {"low", InputImage::Low},
+    });
+
+inline constexpr auto audio_formats = tags<InputAudio::Format>(
+    "InputAudio format",
+    {
+        {"mp3", InputAudio::MP3},
+        {"wav", InputAudio::WAV},
+    });
+
+inline constexpr auto reasoning_formats = tags<OpenResponsesReasoning::Format>(
+    "OpenResponsesReasoning format",
+    {
+        {"unknown", OpenResponsesReasoning::Unknown},
+        {"openai-response-v1", OpenResponsesReasoning::OpenAIResponseV1},
+        {"xai-response-v1", OpenResponsesReasoning::XAIResponseV1},
+        {"anthropic-claude-v1", OpenResponsesReasoning::AnthropicClaudeV1},
+        {"google-gemini-v1", OpenResponsesReasoning::GoogleGeminiV1},
+    });
+
+inline constexpr auto easy_input_roles =
+    tags<OpenResponsesEasyInputMessage::Role>(
+        "OpenResponsesEasyInputMessage role",
+        {
+            {"user", OpenResponsesEasyInputMessage::User},
+            {"system", OpenResponsesEasyInputMessage::System},
+            {"assistant", OpenResponsesEasyInputMessage::Assistant},
+            {"developer", OpenResponsesEasyInputMessage::Developer},
+        });
+
+inline constexpr auto input_item_roles =
+    tags<OpenResponsesInputMessageItem::Role>(
+        "OpenResponsesInputMessageItem role",
+        {
+            {"user", OpenResponsesInputMessageItem::User},
+            {"system", OpenResponsesInputMessageItem::System},
+            {"developer", OpenResponsesInputMessageItem::Developer},
+        });
+
+} // namespace openrouter
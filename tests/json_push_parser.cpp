@@ -0,0 +1,246 @@
+// Differential test of JsonPushParser against nlohmann::json::sax_parse: each
+// document is fed whole, split in two at every offset and one byte at a
+// time, and must produce the same events, or fail exactly when nlohmann
+// does. Strings are not checked for valid UTF-8, so the corpus keeps to it.
+
+#include "json_push_parser.hpp"
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace openrouter;
+
+namespace {
+
+struct Recorder {
+  std::vector<std::string> events;
+
+  bool null() { return add("null"); }
+  bool boolean(bool value) { return add(value ? "true" : "false"); }
+  bool number_integer(std::int64_t value) {
+    return add("int " + std::to_string(value));
+  }
+  bool number_unsigned(std::uint64_t value) {
+    return add("uint " + std::to_string(value));
+  }
+  bool number_float(double value, const std::string &text) {
+    char formatted[32];
+    std::snprintf(formatted, sizeof(formatted), "%.17g", value);
+    return add("float " + std::string(formatted) + " " + text);
+  }
+  bool string(std::string &value) { return add("string " + value); }
+  bool binary(nlohmann::json::binary_t &) { return add("binary"); }
+  bool start_object(std::size_t) { return add("{"); }
+  bool key(std::string &value) { return add("key " + value); }
+  bool end_object() { return add("}"); }
+  bool start_array(std::size_t) { return add("["); }
+  bool end_array() { return add("]"); }
+  bool parse_error(std::size_t, const std::string &,
+                   const nlohmann::json::exception &) {
+    return false;
+  }
+
+  bool add(std::string event) {
+    events.push_back(std::move(event));
+    return true;
+  }
+};
+
+struct Outcome {
+  bool ok = false;
+  std::vector<std::string> events;
+};
+
+Outcome expected(std::string_view json) {
+  Recorder recorder;
+  Outcome outcome;
+  outcome.ok = nlohmann::json::sax_parse(json, &recorder);
+  outcome.events = std::move(recorder.events);
+  return outcome;
+}
+
+Outcome parse(std::string_view json, const std::vector<std::size_t> &splits) {
+  Recorder recorder;
+  JsonPushParser parser(recorder);
+  Outcome outcome;
+  try {
+    std::size_t start = 0;
+    for (std::size_t split : splits) {
+      parser.feed(json.substr(start, split - start));
+      start = split;
+    }
+    parser.feed(json.substr(start));
+    parser.finish();
+    outcome.ok = true;
+  } catch (const std::runtime_error &) {
+  }
+  outcome.events = std::move(recorder.events);
+  return outcome;
+}
+
+int failures = 0;
+
+void check(std::string_view json, const Outcome &want,
+           const std::vector<std::size_t> &splits) {
+  auto got = parse(json, splits);
+  // Events before an error differ in how far each parser reads ahead.
+  if (got.ok == want.ok && (!want.ok || got.events == want.events)) {
+    return;
+  }
+
+  ++failures;
+  std::string at;
+  for (std::size_t split : splits) {
+    at += " " + std::to_string(split);
+  }
+  std::fprintf(stderr, "mismatch for %.*s split at [%s ]: %s, expected %s\n",
+               static_cast<int>(std::min<std::size_t>(json.size(), 200)),
+               json.data(), at.c_str(), got.ok ? "accepted" : "rejected",
+               want.ok ? "accepted" : "rejected");
+}
+
+void differential(std::string_view json) {
+  auto want = expected(json);
+  check(json, want, {});
+  for (std::size_t split = 0; split <= json.size(); ++split) {
+    check(json, want, {split});
+  }
+
+  std::vector<std::size_t> bytes;
+  for (std::size_t i = 1; i < json.size(); ++i) {
+    bytes.push_back(i);
+  }
+  check(json, want, bytes);
+}
+
+std::string random_string(std::minstd_rand &random) {
+  static constexpr std::string_view pieces[] = {
+      "a", "Z", " ", "\\\"", "\\\\", "\\/", "\\n", "\\t", "\\u00e9",
+      "\\uD83D\\uDE00", "\u00e9", "\u6f22", "\xf0\x9f\x99\x82", "\\b"};
+  std::string out = "\"";
+  for (auto n = random() % 8; n > 0; --n) {
+    out += pieces[random() % std::size(pieces)];
+  }
+  return out + "\"";
+}
+
+std::string random_value(std::minstd_rand &random, int depth) {
+  static constexpr std::string_view scalars[] = {
+      "0",       "-0",     "7",           "-42",    "18446744073709551615",
+      "18446744073709551616", "-9223372036854775808", "-9223372036854775809",
+      "0.5",     "-1.25e-3", "6.02E+23",  "1e400",  "true", "false", "null"};
+  switch (depth > 3 ? random() % 2 : random() % 4) {
+  case 0:
+    return std::string(scalars[random() % std::size(scalars)]);
+  case 1:
+    return random_string(random);
+  case 2: {
+    std::string out = "[";
+    for (auto n = random() % 4; n > 0; --n) {
+      out += random_value(random, depth + 1);
+      out += n > 1 ? ", " : "";
+    }
+    return out + "]";
+  }
+  default: {
+    std::string out = "{ ";
+    for (auto n = random() % 4; n > 0; --n) {
+      out += random_string(random) + ":" + random_value(random, depth + 1);
+      out += n > 1 ? ",\n" : "";
+    }
+    return out + "}";
+  }
+  }
+}
+
+} // namespace
+
+int main() {
+  const char *corpus[] = {
+      // Valid.
+      "{}",
+      "[]",
+      " \t\r\n[ ] ",
+      "0",
+      "-0",
+      "123",
+      "-0.0e+0",
+      "3.14159",
+      "1E-7",
+      "\"\"",
+      "\"\\u0041\\u00e9\\u20ac\\uD83D\\uDE00\"",
+      "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"",
+      "[true,false,null]",
+      "{\"a\":{\"b\":[1,[2,[3]],{}]},\"c\":\"d\"}",
+      "{\"id\":\"resp_1\",\"object\":\"response\",\"output\":[{\"type\":"
+      "\"message\",\"id\":\"msg_1\",\"status\":\"completed\",\"role\":"
+      "\"assistant\",\"content\":[{\"type\":\"output_text\",\"text\":"
+      "\"Hello, world!\",\"annotations\":[]}]}],\"usage\":{\"input_tokens\":"
+      "12,\"output_tokens\":3}}",
+      // Invalid.
+      "",
+      " ",
+      "\"\\uD83Dabc\\uDE00\"",
+      "\"\\uD83D\"",
+      "\"\\uD83D\\n\"",
+      "\"\\uD83D\\u0041\"",
+      "\"\\uDE00\"",
+      "\"\\u12\"",
+      "\"\\u12G4\"",
+      "\"\\x\"",
+      "\"abc",
+      "\"a\tb\"",
+      "01",
+      "-01",
+      "00",
+      "1.",
+      "-",
+      "-a",
+      ".5",
+      "1e",
+      "1e400",
+      "-1e400",
+      "1e-400",
+      "1e+",
+      "1.e5",
+      "+1",
+      "1-2",
+      "0x10",
+      "[1,]",
+      "[1 2]",
+      "[",
+      "]",
+      "{\"a\"}",
+      "{\"a\":}",
+      "{\"a\":1,}",
+      "{\"a\" 1}",
+      "{1:2}",
+      "{\"a\":1]",
+      "[1}",
+      "tru",
+      "truex",
+      "nul",
+      "[true1]",
+      "{}{}",
+      "1 2",
+  };
+
+  for (const char *json : corpus) {
+    differential(json);
+  }
+
+  std::minstd_rand random(12345);
+  for (int i = 0; i < 300; ++i) {
+    differential(random_value(random, 0));
+  }
+
+  if (failures) {
+    std::fprintf(stderr, "%d mismatches\n", failures);
+    return 1;
+  }
+  std::puts("json_push_parser: all documents match nlohmann");
+  return 0;
+}
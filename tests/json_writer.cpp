@@ -0,0 +1,82 @@
+// Differential test of JsonWriter's string escaping against nlohmann's dump():
+// random strings mixing ASCII, control characters and multi-byte sequences,
+// valid or not, must either produce the same JSON text or both be refused.
+
+#include "json_writer.hpp"
+#include <cstdio>
+#include <format>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <random>
+#include <string>
+
+using namespace openrouter;
+
+namespace {
+
+std::optional<std::string> writer(const std::string &text) {
+  std::string out;
+  try {
+    JsonWriter w(out);
+    w.value(text);
+  } catch (const std::runtime_error &) {
+    return std::nullopt;
+  }
+  return out;
+}
+
+std::optional<std::string> reference(const std::string &text) {
+  try {
+    return nlohmann::json(text).dump();
+  } catch (const nlohmann::json::type_error &) {
+    return std::nullopt;
+  }
+}
+
+// Pieces chosen to hit every branch of the UTF-8 table: boundaries of each
+// lead byte's continuation range, overlongs, surrogates, values past
+// U+10FFFF, stray continuations and truncated sequences.
+const char *const pieces[] = {
+    "a",        "\"",           "\\",           "/",
+    "\x01",     "\x1f",         "\x7f",         "\n\t",
+    "\xc2\x80", "\xdf\xbf",     "\xc0\x80",     "\xc1\xbf",
+    "\xe0\xa0\x80", "\xe0\x9f\xbf", "\xed\x9f\xbf", "\xed\xa0\x80",
+    "\xef\xbf\xbf", "\xf0\x90\x80\x80", "\xf0\x8f\xbf\xbf",
+    "\xf4\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80",
+    "\x80",     "\xbf",         "\xff",         "\xe2\x82",
+    "\xf0\x9f\x98", "\xe2\x82\xac",
+};
+
+} // namespace
+
+int main() {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<size_t> pick(0, std::size(pieces) - 1);
+  std::uniform_int_distribution<int> count(0, 6);
+
+  int failures = 0;
+  for (int n = 0; n < 200000; ++n) {
+    std::string text;
+    for (int k = count(rng); k > 0; --k) {
+      text += pieces[pick(rng)];
+    }
+    auto got = writer(text);
+    auto want = reference(text);
+    if (got != want) {
+      ++failures;
+      std::string hex;
+      for (unsigned char c : text) {
+        hex += std::format("{:02x}", c);
+      }
+      std::fprintf(stderr, "%s: writer %s, dump %s\n", hex.c_str(),
+                   got ? got->c_str() : "refused",
+                   want ? want->c_str() : "refused");
+    }
+  }
+  if (failures) {
+    std::fprintf(stderr, "%d failures\n", failures);
+    return 1;
+  }
+  std::puts("json_writer: every string matches nlohmann's dump()");
+  return 0;
+}
@@ -0,0 +1,506 @@
+// Drives requests through the client against any base URL and reports
+// latency, time to first byte, throughput and errors. Run with --help.
+
+#include "openrouter/openrouter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace openrouter;
+using Clock = std::chrono::steady_clock;
+
+// Log-linear histogram of microsecond values in the style of HdrHistogram:
+// exact below 128, then 64 linear sub-buckets per power of two, which keeps
+// every value within 1.6% of its bucket. Recording is lock-free.
+class Histogram {
+public:
+  Histogram() : counts(bucket_count) {}
+
+  void record(std::int64_t micros) {
+    auto value = static_cast<std::uint64_t>(std::max<std::int64_t>(0, micros));
+    value = std::min(value, max_trackable);
+    counts[index(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    for (auto seen = max.load(); value > seen &&
+                                 !max.compare_exchange_weak(seen, value);) {
+    }
+  }
+
+  std::uint64_t count() const { return total.load(); }
+
+  // Highest value equivalent to the requested percentile, in microseconds.
+  std::uint64_t percentile(double percent) const {
+    auto target = static_cast<std::uint64_t>(
+        std::ceil(percent / 100 * static_cast<double>(count())));
+    target = std::max<std::uint64_t>(target, 1);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+      seen += counts[i].load();
+      if (seen >= target) {
+        return std::min(highest(i), max.load());
+      }
+    }
+    return max.load();
+  }
+
+  double mean() const {
+    return count() ? static_cast<double>(sum.load()) /
+                         static_cast<double>(count())
+                   : 0;
+  }
+
+  std::uint64_t maximum() const { return max.load(); }
+
+  // HdrHistogram's percentile distribution text format, values in ms.
+  void write_hgrm(std::FILE *out) const;
+
+private:
+  static constexpr std::uint64_t max_trackable = std::uint64_t(1) << 40;
+  static constexpr std::size_t bucket_count = 128 + (40 - 7 + 1) * 64;
+
+  static std::size_t index(std::uint64_t value) {
+    if (value < 128) {
+      return value;
+    }
+    int k = std::bit_width(value) - 1;
+    return 128 + (k - 7) * 64 + ((value >> (k - 6)) - 64);
+  }
+
+  static std::uint64_t highest(std::size_t index) {
+    if (index < 128) {
+      return index;
+    }
+    std::size_t k = (index - 128) / 64 + 7;
+    std::uint64_t sub = (index - 128) % 64 + 64;
+    return ((sub + 1) << (k - 6)) - 1;
+  }
+
+  std::vector<std::atomic<std::uint64_t>> counts;
+  std::atomic<std::uint64_t> total = 0;
+  std::atomic<std::uint64_t> sum = 0;
+  std::atomic<std::uint64_t> max = 0;
+};
+
+void Histogram::write_hgrm(std::FILE *out) const {
+  std::fprintf(out, "%12s %14s %10s %14s\n\n", "Value", "Percentile",
+               "TotalCount", "1/(1-Percentile)");
+  std::uint64_t n = count();
+  if (n == 0) {
+    return;
+  }
+
+  // Five levels per halving of the remaining distance to 100%.
+  for (int half = 0; half < 20; ++half) {
+    double from = 100 * (1 - std::ldexp(1.0, -half));
+    double to = 100 * (1 - std::ldexp(1.0, -(half + 1)));
+    for (int tick = 0; tick < 5; ++tick) {
+      double percent = from + (to - from) * tick / 5;
+      std::uint64_t value = percentile(percent);
+      auto at = static_cast<std::uint64_t>(
+          std::ceil(percent / 100 * static_cast<double>(n)));
+      std::fprintf(out, "%12.3f %14.12f %10llu %14.2f\n",
+                   static_cast<double>(value) / 1000, percent / 100,
+                   static_cast<unsigned long long>(at),
+                   1 / (1 - percent / 100));
+    }
+    if (std::ldexp(1.0, -(half + 1)) * static_cast<double>(n) < 1) {
+      break;
+    }
+  }
+  std::fprintf(out, "%12.3f %14.12f %10llu\n",
+               static_cast<double>(maximum()) / 1000, 1.0,
+               static_cast<unsigned long long>(n));
+  std::fprintf(out, "#[Mean    = %12.3f, Max            = %12.3f]\n",
+               mean() / 1000, static_cast<double>(maximum()) / 1000);
+  std::fprintf(out, "#[Total count    = %12llu]\n",
+               static_cast<unsigned long long>(n));
+}
+
+struct Options {
+  std::string base_url = "http://127.0.0.1:8080/api/v1";
+  std::string model = "openai/gpt-4o-mini";
+  std::chrono::duration<double> duration{10};
+  // Closed loop: this many callers, each sending as soon as the last answer
+  // arrived. Ignored when `rps` is set.
+  int concurrency = 8;
+  // Open loop: arrivals at this rate whatever the latency, so a slow server
+  // builds a backlog instead of slowing the generator down.
+  double rps = 0;
+  bool poisson = false;
+  std::size_t prompt_bytes = 200;
+  // Share of requests sent as streams; closed loop only.
+  double stream = 0;
+  // Closed-loop callers are coroutines on one PollLoop rather than threads.
+  bool coroutines = false;
+  int max_attempts = 1;
+  HttpVersion http_version = HttpVersion::Http2;
+  // Gzip request bodies from this size on, 0 for never.
+  std::size_t compress_min = 0;
+  // Connections opened before the clock starts.
+  std::size_t prewarm = 0;
+  std::string hgrm;
+};
+
+class Stats {
+public:
+  void success(Clock::duration latency) {
+    latencies.record(micros(latency));
+  }
+
+  void ttfb(std::chrono::microseconds value) {
+    first_bytes.record(value.count());
+  }
+
+  void failure(std::exception_ptr error) {
+    std::string kind;
+    try {
+      std::rethrow_exception(error);
+    } catch (const HttpError &e) {
+      kind = std::format("http {}", e.status());
+    } catch (const TransportError &e) {
+      kind = std::format("transport: {}", e.what());
+    } catch (const std::exception &e) {
+      kind = e.what();
+    }
+    std::lock_guard lock(mutex);
+    ++errors[kind];
+  }
+
+  void report(const Options &options, std::chrono::duration<double> elapsed,
+              const ConnectionStats &connections,
+              const CompressionStats &compression);
+
+private:
+  static std::int64_t micros(Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+        .count();
+  }
+
+  Histogram latencies;
+  Histogram first_bytes;
+  std::mutex mutex;
+  std::map<std::string, std::uint64_t> errors;
+};
+
+void Stats::report(const Options &options,
+                   std::chrono::duration<double> elapsed,
+                   const ConnectionStats &connections,
+                   const CompressionStats &compression) {
+  std::uint64_t failed = 0;
+  for (const auto &[kind, n] : errors) {
+    failed += n;
+  }
+  std::uint64_t ok = latencies.count();
+  std::uint64_t total = ok + failed;
+
+  std::printf("requests %llu  ok %llu  errors %llu (%.2f%%)  "
+              "elapsed %.2fs  throughput %.1f req/s\n",
+              static_cast<unsigned long long>(total),
+              static_cast<unsigned long long>(ok),
+              static_cast<unsigned long long>(failed),
+              total ? 100.0 * static_cast<double>(failed) /
+                          static_cast<double>(total)
+                    : 0.0,
+              elapsed.count(), static_cast<double>(ok) / elapsed.count());
+
+  auto row = [](const char *name, const Histogram &h) {
+    auto ms = [&](double p) {
+      return static_cast<double>(h.percentile(p)) / 1000;
+    };
+    std::printf("%-8s p50 %9.2f  p90 %9.2f  p99 %9.2f  p999 %9.2f  "
+                "max %9.2f ms\n",
+                name, ms(50), ms(90), ms(99), ms(99.9),
+                static_cast<double>(h.maximum()) / 1000);
+  };
+  row("latency", latencies);
+  row("ttfb", first_bytes);
+  std::printf("connections opened %llu  reused %llu  http2 transfers %llu\n",
+              static_cast<unsigned long long>(connections.new_connections),
+              static_cast<unsigned long long>(connections.reused),
+              static_cast<unsigned long long>(connections.http2));
+  if (compression.compressed + compression.skipped > 0) {
+    std::printf("gzip     %llu bodies  ratio %.2f  %.1f us per body\n",
+                static_cast<unsigned long long>(compression.compressed),
+                compression.bytes_out
+                    ? static_cast<double>(compression.bytes_in) /
+                          static_cast<double>(compression.bytes_out)
+                    : 0.0,
+                static_cast<double>(compression.time.count()) /
+                    static_cast<double>(compression.compressed +
+                                        compression.skipped));
+  }
+
+  for (const auto &[kind, n] : errors) {
+    std::printf("  %8llu  %s\n", static_cast<unsigned long long>(n),
+                kind.c_str());
+  }
+
+  if (!options.hgrm.empty()) {
+    std::FILE *out = std::fopen(options.hgrm.c_str(), "w");
+    if (!out) {
+      throw std::runtime_error(
+          std::format("Cannot write {}", options.hgrm));
+    }
+    latencies.write_hgrm(out);
+    std::fclose(out);
+  }
+}
+
+static void closed_loop(OpenRouter &client, const Options &options,
+                        const Request &request, Stats &stats,
+                        Clock::time_point deadline) {
+  Request streamed = request;
+  streamed.stream = true;
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < options.concurrency; ++i) {
+    workers.emplace_back([&, seed = i] {
+      std::minstd_rand rng(seed + 1);
+      std::uniform_real_distribution<double> unit;
+      while (Clock::now() < deadline) {
+        bool stream = unit(rng) < options.stream;
+        auto started = Clock::now();
+        try {
+          if (stream) {
+            client.create_response(streamed,
+                                   [](const ResponseStreamEvent &) {});
+          } else {
+            client.create_response(request);
+          }
+          stats.success(Clock::now() - started);
+        } catch (...) {
+          stats.failure(std::current_exception());
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+static Task<> caller(OpenRouter &client, const Request &request,
+                     Stats &stats, Clock::time_point deadline, PollLoop &loop,
+                     int &remaining) {
+  while (Clock::now() < deadline) {
+    auto started = Clock::now();
+    try {
+      co_await client.co_create_response(request);
+      stats.success(Clock::now() - started);
+    } catch (...) {
+      stats.failure(std::current_exception());
+    }
+  }
+  if (--remaining == 0) {
+    loop.stop();
+  }
+}
+
+// The closed loop without a thread per caller: every caller runs on the
+// thread that runs `loop`, which is also the client's.
+static void coroutine_loop(OpenRouter &client, PollLoop &loop,
+                           const Options &options, const Request &request,
+                           Stats &stats, Clock::time_point deadline) {
+  int remaining = options.concurrency;
+  std::vector<Task<>> callers;
+  for (int i = 0; i < options.concurrency; ++i) {
+    callers.push_back(
+        caller(client, request, stats, deadline, loop, remaining));
+    callers.back().start();
+  }
+  if (remaining > 0) {
+    loop.run();
+  }
+}
+
+// Latency is measured from when a request was due rather than when it was
+// sent, so a stalled generator cannot hide queueing.
+static void open_loop(OpenRouter &client, const Options &options,
+                      const Request &request, Stats &stats,
+                      Clock::time_point deadline) {
+  std::mt19937_64 rng(1);
+  std::exponential_distribution<double> gaps(options.rps);
+  std::atomic<std::uint64_t> pending = 0;
+
+  auto due = Clock::now();
+  while (due < deadline) {
+    std::this_thread::sleep_until(due);
+    ++pending;
+    client.create_response_async(
+        request, [&stats, &pending, due](ResponseResult result) {
+          if (result) {
+            stats.success(Clock::now() - due);
+          } else {
+            stats.failure(result.error());
+          }
+          --pending;
+        });
+
+    double gap = options.poisson ? gaps(rng) : 1 / options.rps;
+    due += std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(gap));
+  }
+
+  while (pending > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+static double number(std::string_view text) {
+  double value = 0;
+  auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  if (ec != std::errc() || end != text.data() + text.size()) {
+    throw std::runtime_error(std::format("Invalid number: {}", text));
+  }
+  return value;
+}
+
+static HttpVersion http_version(std::string_view text) {
+  if (text == "1.1") {
+    return HttpVersion::Http1;
+  } else if (text == "2") {
+    return HttpVersion::Http2;
+  } else if (text == "h2c") {
+    return HttpVersion::Http2PriorKnowledge;
+  }
+  throw std::runtime_error(std::format("Unknown HTTP version: {}", text));
+}
+
+static void usage() {
+  std::puts(
+      "usage: openrouter-loadgen [options]\n"
+      "  --base-url=URL        endpoint root (http://127.0.0.1:8080/api/v1)\n"
+      "  --model=NAME          model to request\n"
+      "  --duration=S          how long to send for (10)\n"
+      "  --concurrency=N       closed loop with N callers (8)\n"
+      "  --rps=R               open loop at R requests/s instead\n"
+      "  --poisson             exponential gaps in the open loop\n"
+      "  --prompt-bytes=N      size of the user message (200)\n"
+      "  --stream=P            share of streamed requests, closed loop (0)\n"
+      "  --coroutines          closed-loop callers as coroutines on one\n"
+      "                        thread instead of a thread each\n"
+      "  --max-attempts=N      client retry attempts (1)\n"
+      "  --http=VERSION        1.1, 2 (negotiated) or h2c (2)\n"
+      "  --gzip=N              gzip request bodies of N bytes or more\n"
+      "  --prewarm=N           open N connections before starting\n"
+      "  --hgrm=FILE           write the latency distribution for\n"
+      "                        HdrHistogram plotters\n"
+      "The API key comes from OPENROUTER_API_KEY when set.");
+}
+
+int main(int argc, char **argv) {
+  Options options;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string_view arg = argv[i];
+      std::size_t equals = arg.find('=');
+      std::string_view name = arg.substr(0, equals);
+      std::string_view value =
+          equals == std::string_view::npos ? "" : arg.substr(equals + 1);
+
+      if (name == "--base-url") {
+        options.base_url = value;
+      } else if (name == "--model") {
+        options.model = value;
+      } else if (name == "--duration") {
+        options.duration = std::chrono::duration<double>(number(value));
+      } else if (name == "--concurrency") {
+        options.concurrency = static_cast<int>(number(value));
+      } else if (name == "--rps") {
+        options.rps = number(value);
+      } else if (name == "--poisson") {
+        options.poisson = true;
+      } else if (name == "--prompt-bytes") {
+        options.prompt_bytes = static_cast<std::size_t>(number(value));
+      } else if (name == "--stream") {
+        options.stream = number(value);
+      } else if (name == "--coroutines") {
+        options.coroutines = true;
+      } else if (name == "--max-attempts") {
+        options.max_attempts = static_cast<int>(number(value));
+      } else if (name == "--http") {
+        options.http_version = http_version(value);
+      } else if (name == "--gzip") {
+        options.compress_min = static_cast<std::size_t>(number(value));
+      } else if (name == "--prewarm") {
+        options.prewarm = static_cast<std::size_t>(number(value));
+      } else if (name == "--hgrm") {
+        options.hgrm = value;
+      } else {
+        usage();
+        return name == "--help" ? 0 : 2;
+      }
+    }
+    if (options.rps > 0 && options.stream > 0) {
+      throw std::runtime_error("Streamed requests need the closed loop");
+    }
+    if (options.coroutines && (options.stream > 0 || options.prewarm > 0)) {
+      throw std::runtime_error(
+          "--coroutines cannot be combined with --stream or --prewarm");
+    }
+
+    Stats stats;
+    PollLoop loop;
+    ClientOptions client_options;
+    client_options.base_url = options.base_url;
+    if (options.coroutines && options.rps == 0) {
+      client_options.event_loop = &loop;
+    }
+    client_options.retry.max_attempts = options.max_attempts;
+    client_options.connection.http_version = options.http_version;
+    if (options.compress_min > 0) {
+      client_options.compression.compress_requests = true;
+      client_options.compression.min_size = options.compress_min;
+    }
+    client_options.hooks.after_attempt =
+        [&stats](const RequestTiming &timing, std::exception_ptr error) {
+          if (!error) {
+            stats.ttfb(timing.start_transfer);
+          }
+        };
+
+    const char *key = std::getenv("OPENROUTER_API_KEY");
+    OpenRouter client(key ? key : "loadgen", client_options);
+
+    Request request;
+    request.model = options.model;
+    request.input = std::string(options.prompt_bytes, 'x');
+
+    if (options.prewarm > 0) {
+      client.prewarm(options.prewarm);
+    }
+
+    auto started = Clock::now();
+    auto deadline =
+        started + std::chrono::duration_cast<Clock::duration>(options.duration);
+    if (options.rps > 0) {
+      open_loop(client, options, request, stats, deadline);
+    } else if (options.coroutines) {
+      coroutine_loop(client, loop, options, request, stats, deadline);
+    } else {
+      closed_loop(client, options, request, stats, deadline);
+    }
+    stats.report(options, Clock::now() - started, client.connection_stats(),
+                 client.compression_stats());
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "openrouter-loadgen: %s\n", e.what());
+    return 1;
+  }
+}
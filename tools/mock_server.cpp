@@ -0,0 +1,542 @@
+// Loopback stand-in for the OpenRouter Responses API, for load tests and
+// end-to-end benchmarks. Point ClientOptions::base_url at
+// http://127.0.0.1:PORT/api/v1. Run with --help for the knobs.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+using Clock = std::chrono::steady_clock;
+
+// Time to first byte, sampled per request.
+struct Latency {
+  enum Kind {
+    Fixed,
+    Uniform,
+    LogNormal,
+  };
+
+  Kind kind = Fixed;
+  double a = 0;
+  double b = 0;
+
+  // fixed:MS, uniform:MIN_MS:MAX_MS or lognormal:MEDIAN_MS:SIGMA.
+  static Latency parse(std::string_view spec);
+
+  std::chrono::microseconds sample(std::mt19937_64 &rng) const {
+    double ms = a;
+    if (kind == Uniform) {
+      ms = std::uniform_real_distribution<double>(a, b)(rng);
+    } else if (kind == LogNormal) {
+      ms = std::lognormal_distribution<double>(std::log(a), b)(rng);
+    }
+    return std::chrono::microseconds(static_cast<long long>(ms * 1000));
+  }
+};
+
+struct Options {
+  std::string host = "127.0.0.1";
+  int port = 8080;
+  Latency latency;
+  // Output tokens per generated response, and how fast they are produced.
+  // A rate of 0 sends everything at once.
+  int tokens = 50;
+  double tokens_per_second = 0;
+  // Fault probabilities, each in [0, 1].
+  double rate_429 = 0;
+  double rate_5xx = 0;
+  double rate_truncate = 0;
+  int retry_after = 1;
+  std::vector<std::string> replay;
+};
+
+// What a response says, as both a full body and the deltas of a stream.
+struct Canned {
+  nlohmann::json response;
+  std::vector<std::string> deltas;
+};
+
+static double number(std::string_view text) {
+  double value = 0;
+  auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  if (ec != std::errc() || end != text.data() + text.size()) {
+    throw std::runtime_error(std::format("Invalid number: {}", text));
+  }
+  return value;
+}
+
+Latency Latency::parse(std::string_view spec) {
+  std::vector<std::string_view> parts;
+  for (std::size_t start = 0;;) {
+    std::size_t colon = spec.find(':', start);
+    parts.push_back(spec.substr(start, colon - start));
+    if (colon == std::string_view::npos) {
+      break;
+    }
+    start = colon + 1;
+  }
+
+  if (parts.size() == 2 && parts[0] == "fixed") {
+    return {Fixed, number(parts[1]), 0};
+  } else if (parts.size() == 3 && parts[0] == "uniform") {
+    return {Uniform, number(parts[1]), number(parts[2])};
+  } else if (parts.size() == 3 && parts[0] == "lognormal") {
+    return {LogNormal, number(parts[1]), number(parts[2])};
+  }
+  throw std::runtime_error(std::format("Invalid latency: {}", spec));
+}
+
+static Canned canned(nlohmann::json response) {
+  Canned result{std::move(response), {}};
+  for (const auto &item : result.response.value("output", nlohmann::json())) {
+    if (item.value("type", "") != "message") {
+      continue;
+    }
+    for (const auto &part : item.value("content", nlohmann::json())) {
+      std::string_view text = part.value("text", std::string_view());
+      // One delta per word, keeping the separator with it.
+      while (!text.empty()) {
+        std::size_t end = text.find(' ', 1);
+        end = end == std::string_view::npos ? text.size() : end;
+        result.deltas.emplace_back(text.substr(0, end));
+        text.remove_prefix(end);
+      }
+    }
+  }
+  return result;
+}
+
+static Canned generated(int tokens, std::uint64_t id) {
+  static constexpr std::string_view words[] = {
+      "The",   "quick", "brown", "fox",   "jumps", "over", "the",
+      "lazy",  "dog",   "while", "tokens", "stream", "in", "steadily."};
+  std::string text;
+  for (int i = 0; i < tokens; ++i) {
+    if (i > 0) {
+      text += ' ';
+    }
+    text += words[i % std::size(words)];
+  }
+
+  return canned(
+      {{"id", std::format("resp_mock_{}", id)},
+       {"object", "response"},
+       {"created_at", 0},
+       {"model", "mock/model"},
+       {"status", "completed"},
+       {"output",
+        {{{"type", "message"},
+          {"id", std::format("msg_mock_{}", id)},
+          {"status", "completed"},
+          {"role", "assistant"},
+          {"content",
+           {{{"type", "output_text"},
+             {"text", std::move(text)},
+             {"annotations", nlohmann::json::array()}}}}}}},
+       {"usage",
+        {{"input_tokens", 0},
+         {"output_tokens", tokens},
+         {"total_tokens", tokens}}}});
+}
+
+static std::vector<Canned> load_replay(const std::vector<std::string> &paths) {
+  std::vector<std::filesystem::path> files;
+  for (const auto &path : paths) {
+    if (std::filesystem::is_directory(path)) {
+      for (const auto &entry : std::filesystem::directory_iterator(path)) {
+        if (entry.path().extension() == ".json") {
+          files.push_back(entry.path());
+        }
+      }
+    } else {
+      files.emplace_back(path);
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  std::vector<Canned> result;
+  for (const auto &file : files) {
+    std::ifstream in(file);
+    if (!in) {
+      throw std::runtime_error(
+          std::format("Cannot read replay file {}", file.string()));
+    }
+    result.push_back(canned(nlohmann::json::parse(in)));
+  }
+  return result;
+}
+
+static bool send_all(int fd, std::string_view data) {
+  while (!data.empty()) {
+    ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    data.remove_prefix(static_cast<std::size_t>(n));
+  }
+  return true;
+}
+
+static bool send_chunk(int fd, std::string_view data) {
+  return send_all(fd, std::format("{:x}\r\n{}\r\n", data.size(), data));
+}
+
+static std::string sse(std::string_view event, const nlohmann::json &data) {
+  return std::format("event: {}\ndata: {}\n\n", event, data.dump());
+}
+
+struct HttpRequest {
+  std::string method;
+  std::string path;
+  std::string body;
+  bool gzip = false;
+  bool close = false;
+};
+
+// Reads one request off a keep-alive connection. `buffer` carries bytes
+// that arrived past the previous request.
+static bool read_request(int fd, std::string &buffer, HttpRequest &request) {
+  char chunk[64 * 1024];
+  std::size_t header_end;
+  while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+    ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) {
+      return false;
+    }
+    buffer.append(chunk, static_cast<std::size_t>(n));
+  }
+
+  std::istringstream head(buffer.substr(0, header_end));
+  std::string line;
+  std::getline(head, line);
+  std::istringstream(line) >> request.method >> request.path;
+
+  std::size_t length = 0;
+  request.close = false;
+  request.gzip = false;
+  while (std::getline(head, line)) {
+    std::string lower = line;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (lower.starts_with("content-length:")) {
+      length = std::stoull(line.substr(15));
+    } else if (lower.starts_with("connection:") &&
+               lower.find("close") != std::string::npos) {
+      request.close = true;
+    } else if (lower.starts_with("content-encoding:") &&
+               lower.find("gzip") != std::string::npos) {
+      request.gzip = true;
+    }
+  }
+
+  std::size_t total = header_end + 4 + length;
+  while (buffer.size() < total) {
+    ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) {
+      return false;
+    }
+    buffer.append(chunk, static_cast<std::size_t>(n));
+  }
+  request.body = buffer.substr(header_end + 4, length);
+  buffer.erase(0, total);
+  return true;
+}
+
+static bool gunzip(std::string &body) {
+  z_stream stream{};
+  if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+    return false;
+  }
+
+  std::string out;
+  char chunk[64 * 1024];
+  stream.next_in = reinterpret_cast<Bytef *>(body.data());
+  stream.avail_in = static_cast<uInt>(body.size());
+  int res = Z_OK;
+  while (res == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef *>(chunk);
+    stream.avail_out = sizeof(chunk);
+    res = inflate(&stream, Z_NO_FLUSH);
+    out.append(chunk, sizeof(chunk) - stream.avail_out);
+  }
+  inflateEnd(&stream);
+
+  if (res != Z_STREAM_END) {
+    return false;
+  }
+  body = std::move(out);
+  return true;
+}
+
+class Server {
+public:
+  explicit Server(Options options)
+      : options(std::move(options)),
+        replay(load_replay(this->options.replay)) {}
+
+  void run();
+
+private:
+  void serve(int fd);
+  // Returns false when the connection must be closed.
+  bool respond(int fd, HttpRequest &request, std::mt19937_64 &rng);
+  bool send_error(int fd, int status, std::string_view message);
+  bool send_json(int fd, const Canned &response, bool truncate);
+  bool send_stream(int fd, const Canned &response, bool truncate);
+  void pace(std::size_t tokens) const;
+
+  Options options;
+  std::vector<Canned> replay;
+  std::atomic<std::uint64_t> requests = 0;
+};
+
+void Server::run() {
+  int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  int yes = 1;
+  ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+  if (::inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+    throw std::runtime_error(std::format("Invalid host: {}", options.host));
+  }
+  if (::bind(listener, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) != 0 ||
+      ::listen(listener, SOMAXCONN) != 0) {
+    throw std::runtime_error(std::format("Cannot listen on {}:{}: {}",
+                                         options.host, options.port,
+                                         std::strerror(errno)));
+  }
+  std::printf("Listening on http://%s:%d/api/v1/responses\n",
+              options.host.c_str(), options.port);
+  std::fflush(stdout);
+
+  for (;;) {
+    int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    std::thread([this, fd] { serve(fd); }).detach();
+  }
+}
+
+void Server::serve(int fd) {
+  std::mt19937_64 rng(std::random_device{}());
+  std::string buffer;
+  HttpRequest request;
+  while (read_request(fd, buffer, request) && respond(fd, request, rng) &&
+         !request.close) {
+  }
+  ::close(fd);
+}
+
+bool Server::respond(int fd, HttpRequest &request, std::mt19937_64 &rng) {
+  // What a client sends to warm a connection; HEAD answers carry no body.
+  if (request.method == "HEAD") {
+    return send_all(fd, "HTTP/1.1 405 Method Not Allowed\r\n"
+                        "Allow: POST\r\n"
+                        "Content-Length: 0\r\n\r\n");
+  }
+  if (request.method != "POST" || !request.path.ends_with("/responses")) {
+    return send_error(fd, 404, "Not found");
+  }
+  if (request.gzip && !gunzip(request.body)) {
+    return send_error(fd, 400, "Malformed gzip body");
+  }
+
+  std::uint64_t id = requests++;
+  std::uniform_real_distribution<double> unit;
+  std::this_thread::sleep_for(options.latency.sample(rng));
+
+  double fault = unit(rng);
+  if (fault < options.rate_429) {
+    return send_error(fd, 429, "Rate limit exceeded");
+  }
+  if (fault < options.rate_429 + options.rate_5xx) {
+    static constexpr int statuses[] = {500, 502, 503};
+    return send_error(fd, statuses[rng() % std::size(statuses)],
+                      "Upstream error");
+  }
+
+  Canned fresh;
+  const Canned *response = &fresh;
+  if (replay.empty()) {
+    fresh = generated(options.tokens, id);
+  } else {
+    response = &replay[id % replay.size()];
+  }
+
+  // Cheaper than parsing a large body; the client writes no whitespace.
+  bool stream = request.body.find("\"stream\":true") != std::string::npos ||
+                request.body.find("\"stream\": true") != std::string::npos;
+  bool truncate = unit(rng) < options.rate_truncate;
+  return stream ? send_stream(fd, *response, truncate)
+                : send_json(fd, *response, truncate);
+}
+
+bool Server::send_error(int fd, int status, std::string_view message) {
+  std::string body =
+      nlohmann::json{{"error", {{"code", status}, {"message", message}}}}
+          .dump();
+  std::string retry_after;
+  if (status == 429) {
+    retry_after = std::format("Retry-After: {}\r\n", options.retry_after);
+  }
+  return send_all(fd, std::format("HTTP/1.1 {} Error\r\n"
+                                  "Content-Type: application/json\r\n"
+                                  "Content-Length: {}\r\n{}\r\n{}",
+                                  status, body.size(), retry_after, body));
+}
+
+void Server::pace(std::size_t tokens) const {
+  if (options.tokens_per_second > 0) {
+    std::this_thread::sleep_for(std::chrono::duration<double>(
+        static_cast<double>(tokens) / options.tokens_per_second));
+  }
+}
+
+// A truncated body promises its full length and stops halfway.
+bool Server::send_json(int fd, const Canned &response, bool truncate) {
+  pace(response.deltas.size());
+  std::string body = response.response.dump();
+  std::string head = std::format("HTTP/1.1 200 OK\r\n"
+                                 "Content-Type: application/json\r\n"
+                                 "Content-Length: {}\r\n\r\n",
+                                 body.size());
+  if (truncate) {
+    send_all(fd, head + body.substr(0, body.size() / 2));
+    return false;
+  }
+  return send_all(fd, head + body);
+}
+
+// A truncated stream stops halfway through the deltas without ending the
+// chunked body.
+bool Server::send_stream(int fd, const Canned &response, bool truncate) {
+  if (!send_all(fd, "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: text/event-stream\r\n"
+                    "Cache-Control: no-cache\r\n"
+                    "Transfer-Encoding: chunked\r\n\r\n")) {
+    return false;
+  }
+
+  nlohmann::json created = response.response;
+  created["status"] = "in_progress";
+  created["output"] = nlohmann::json::array();
+  if (!send_chunk(fd, sse("response.created",
+                          {{"type", "response.created"},
+                           {"response", std::move(created)}}))) {
+    return false;
+  }
+
+  std::size_t limit =
+      truncate ? response.deltas.size() / 2 : response.deltas.size();
+  for (std::size_t i = 0; i < limit; ++i) {
+    pace(1);
+    if (!send_chunk(fd, sse("response.output_text.delta",
+                            {{"type", "response.output_text.delta"},
+                             {"item_id", "msg_mock"},
+                             {"output_index", 0},
+                             {"content_index", 0},
+                             {"delta", response.deltas[i]}}))) {
+      return false;
+    }
+  }
+  if (truncate) {
+    return false;
+  }
+
+  return send_chunk(fd, sse("response.completed",
+                            {{"type", "response.completed"},
+                             {"response", response.response}})) &&
+         send_chunk(fd, "data: [DONE]\n\n") && send_all(fd, "0\r\n\r\n");
+}
+
+static void usage() {
+  std::puts(
+      "usage: openrouter-mock [options]\n"
+      "  --host=ADDR             listen address (127.0.0.1)\n"
+      "  --port=N                listen port (8080)\n"
+      "  --latency=SPEC          time to first byte: fixed:MS,\n"
+      "                          uniform:MIN_MS:MAX_MS or\n"
+      "                          lognormal:MEDIAN_MS:SIGMA (fixed:0)\n"
+      "  --tokens=N              words per generated response (50)\n"
+      "  --tokens-per-second=R   pace output, streamed or not (unpaced)\n"
+      "  --error-429=P           probability of a 429 (0)\n"
+      "  --error-5xx=P           probability of a 500/502/503 (0)\n"
+      "  --truncate=P            probability of a body cut in half (0)\n"
+      "  --retry-after=S         Retry-After sent with 429s (1)\n"
+      "  --replay=PATH           serve canned response bodies round-robin;\n"
+      "                          a file or a directory of *.json, may repeat");
+}
+
+int main(int argc, char **argv) {
+  Options options;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string_view arg = argv[i];
+      std::size_t equals = arg.find('=');
+      std::string_view name = arg.substr(0, equals);
+      std::string_view value =
+          equals == std::string_view::npos ? "" : arg.substr(equals + 1);
+
+      if (name == "--host") {
+        options.host = value;
+      } else if (name == "--port") {
+        options.port = static_cast<int>(number(value));
+      } else if (name == "--latency") {
+        options.latency = Latency::parse(value);
+      } else if (name == "--tokens") {
+        options.tokens = static_cast<int>(number(value));
+      } else if (name == "--tokens-per-second") {
+        options.tokens_per_second = number(value);
+      } else if (name == "--error-429") {
+        options.rate_429 = number(value);
+      } else if (name == "--error-5xx") {
+        options.rate_5xx = number(value);
+      } else if (name == "--truncate") {
+        options.rate_truncate = number(value);
+      } else if (name == "--retry-after") {
+        options.retry_after = static_cast<int>(number(value));
+      } else if (name == "--replay") {
+        options.replay.emplace_back(value);
+      } else {
+        usage();
+        return name == "--help" ? 0 : 2;
+      }
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    Server(std::move(options)).run();
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "openrouter-mock: %s\n", e.what());
+    return 1;
+  }
+}